@@ -1,6 +1,214 @@
+#include "pcd_parser/pcd_cache.h"
 #include "pcd_parser/pcd_parser.h"
+#include "pcd_parser/pcd_prefetcher.h"
+#include "pcd_parser/pcd_scanner.h"
+#include "pcd_parser/selection.h"
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
 #include <napi.h>
 
+// Parsed clouds shared by parse() and getField() across requests. Writers
+// invalidate their file explicitly: in-place label patches may leave the
+// modification time unchanged within its resolution.
+static pcd::PCDCache cloudCache(512u << 20);
+
+// Background parses into cloudCache; workers start on first use
+static std::unique_ptr<pcd::PCDPrefetcher> prefetcher;
+
+// Build the JavaScript header object shared by parse() and probe()
+static Napi::Object HeaderToObject(Napi::Env env, const pcd::PCDHeader &hdr,
+                                   int points) {
+  Napi::Object header = Napi::Object::New(env);
+  header.Set("version", hdr.version);
+  header.Set("width", hdr.width);
+  header.Set("height", hdr.height);
+  header.Set("points", points);
+  header.Set("dataType", hdr.dataType);
+
+  // Field names, types, and sizes
+  Napi::Array fieldNames = Napi::Array::New(env, hdr.fields.size());
+  Napi::Array fieldTypes = Napi::Array::New(env, hdr.fields.size());
+  Napi::Array fieldSizes = Napi::Array::New(env, hdr.fields.size());
+  for (size_t i = 0; i < hdr.fields.size(); i++) {
+    fieldNames[i] = Napi::String::New(env, hdr.fields[i].name);
+    fieldTypes[i] = Napi::String::New(env, std::string(1, hdr.fields[i].type));
+    fieldSizes[i] = Napi::Number::New(env, hdr.fields[i].size);
+  }
+  header.Set("fields", fieldNames);
+  header.Set("fieldTypes", fieldTypes);
+  header.Set("fieldSizes", fieldSizes);
+  return header;
+}
+
+// Decoded point cloud ready to hand to JavaScript. Built entirely in C++ so
+// it can be produced on a worker thread.
+struct DecodedCloud {
+  pcd::PCDHeader header;
+  size_t numPoints = 0;
+  std::vector<float> positions;
+  std::vector<uint32_t> labels;
+  std::vector<std::pair<std::string, pcd::FieldData>> fields; // Native types
+  bool hasColor = false;
+  std::vector<float> color;
+  // Voxel previews: leaf size, full point count and the original index of
+  // each returned point
+  double voxelSize = 0;
+  size_t sourcePoints = 0;
+  std::vector<uint32_t> voxelIndices;
+};
+
+// Read parse() options: { threads, fields }
+static pcd::ParseOptions ReadParseOptions(const Napi::CallbackInfo &info,
+                                          size_t index) {
+  pcd::ParseOptions options;
+  if (info.Length() > index && info[index].IsObject()) {
+    Napi::Object opts = info[index].As<Napi::Object>();
+    if (opts.Has("threads") && opts.Get("threads").IsNumber()) {
+      int threads = opts.Get("threads").As<Napi::Number>().Int32Value();
+      options.threads = threads > 0 ? static_cast<unsigned>(threads) : 0;
+    }
+    if (opts.Has("fields") && opts.Get("fields").IsArray()) {
+      Napi::Array fields = opts.Get("fields").As<Napi::Array>();
+      for (uint32_t i = 0; i < fields.Length(); i++) {
+        Napi::Value name = fields.Get(i);
+        if (name.IsString())
+          options.fields.push_back(name.As<Napi::String>().Utf8Value());
+      }
+    }
+  }
+  return options;
+}
+
+// Read the voxel preview size from an options object ({ voxel }); 0 = off
+static double ReadVoxelSize(const Napi::CallbackInfo &info, size_t index) {
+  if (info.Length() > index && info[index].IsObject()) {
+    Napi::Value voxel = info[index].As<Napi::Object>().Get("voxel");
+    if (voxel.IsNumber())
+      return voxel.As<Napi::Number>().DoubleValue();
+  }
+  return 0;
+}
+
+// Voxel grid over a file's positions, from the cache
+static pcd::VoxelGrid CachedVoxelGrid(const std::string &filepath,
+                                      double voxel, unsigned threads = 0) {
+  pcd::ParseOptions positions;
+  positions.fields = {"x", "y", "z"};
+  return pcd::PCDParser::voxelGrid(*cloudCache.get(filepath, positions), voxel,
+                                   threads);
+}
+
+static DecodedCloud DecodeCloud(const std::string &filepath,
+                                const pcd::ParseOptions &options,
+                                double voxel = 0) {
+  std::shared_ptr<const pcd::PCDData> cached =
+      cloudCache.get(filepath, options);
+
+  DecodedCloud cloud;
+  // Voxel previews decode the representative points only
+  if (voxel > 0) {
+    pcd::VoxelGrid grid = CachedVoxelGrid(filepath, voxel, options.threads);
+    cloud.voxelSize = voxel;
+    cloud.sourcePoints = cached->numPoints();
+    cached = std::make_shared<const pcd::PCDData>(
+        pcd::PCDParser::subset(*cached, grid.representatives));
+    cloud.voxelIndices = std::move(grid.representatives);
+  }
+  const pcd::PCDData &data = *cached;
+
+  cloud.header = data.header;
+  cloud.numPoints = data.numPoints();
+  cloud.positions = data.getPositions();
+  cloud.labels = data.getLabels();
+  cloud.hasColor = data.hasRGB();
+  if (cloud.hasColor) {
+    cloud.color = data.getRGB();
+  }
+
+  // Only decoded fields are returned; the rest load through getField()
+  std::vector<bool> decoded(data.header.fields.size(), options.fields.empty());
+  for (const auto &name : options.fields) {
+    int idx = data.header.findField(name);
+    if (idx >= 0)
+      decoded[idx] = true;
+  }
+  // Columns are copied out of the cache in their on-disk element types
+  for (size_t i = 0; i < data.header.fields.size(); i++) {
+    if (decoded[i]) {
+      cloud.fields.emplace_back(data.header.fields[i].name, data.fieldData[i]);
+    }
+  }
+  return cloud;
+}
+
+// Hand a vector to JavaScript without copying: the storage moves to the heap
+// and is owned by an external ArrayBuffer whose finalizer frees it
+template <typename T>
+static Napi::TypedArrayOf<T> ExternalTypedArray(Napi::Env env,
+                                                std::vector<T> &&values) {
+  if (values.empty()) {
+    return Napi::TypedArrayOf<T>::New(env, 0);
+  }
+
+  auto *storage = new std::vector<T>(std::move(values));
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+      env, storage->data(), storage->size() * sizeof(T),
+      [](Napi::Env, void *, std::vector<T> *owned) { delete owned; }, storage);
+  return Napi::TypedArrayOf<T>::New(env, storage->size(), buffer, 0);
+}
+
+// Hand a column to JavaScript as the TypedArray matching its element type
+// (Int8Array ... Float64Array)
+static Napi::Value ColumnToTypedArray(Napi::Env env, pcd::FieldData &&column) {
+  return std::visit(
+      [env](auto &vec) -> Napi::Value {
+        return ExternalTypedArray(env, std::move(vec));
+      },
+      column);
+}
+
+// Build the parse() result, taking ownership of the decoded columns
+static Napi::Object CloudToObject(Napi::Env env, DecodedCloud &&cloud) {
+  // Create result object
+  Napi::Object result = Napi::Object::New(env);
+
+  result.Set("header", HeaderToObject(env, cloud.header,
+                                      static_cast<int>(cloud.numPoints)));
+
+  // Positions as Float32Array (interleaved x,y,z)
+  result.Set("positions", ExternalTypedArray(env, std::move(cloud.positions)));
+
+  // Labels as Uint32Array
+  result.Set("labels", ExternalTypedArray(env, std::move(cloud.labels)));
+
+  // All fields as named TypedArrays of their native type (for colorization)
+  Napi::Object fields = Napi::Object::New(env);
+  for (auto &field : cloud.fields) {
+    fields.Set(field.first, ColumnToTypedArray(env, std::move(field.second)));
+  }
+
+  // Add synthetic _color field if RGB data is available
+  // This contains interleaved r,g,b floats (normalized 0-1) for color
+  // interpretation The raw rgb/rgba fields remain as scalars above
+  if (cloud.hasColor) {
+    fields.Set("_color", ExternalTypedArray(env, std::move(cloud.color)));
+  }
+  result.Set("fields", fields);
+
+  if (cloud.voxelSize > 0) {
+    Napi::Object voxel = Napi::Object::New(env);
+    voxel.Set("size", cloud.voxelSize);
+    voxel.Set("sourcePoints", static_cast<double>(cloud.sourcePoints));
+    voxel.Set("indices", ExternalTypedArray(env, std::move(cloud.voxelIndices)));
+    result.Set("voxel", voxel);
+  }
+
+  return result;
+}
+
 // Parse a PCD file and return JavaScript object
 Napi::Value ParsePCD(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
@@ -12,78 +220,38 @@ Napi::Value ParsePCD(const Napi::CallbackInfo &info) {
   }
 
   std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  pcd::ParseOptions options = ReadParseOptions(info, 1);
 
   try {
-    pcd::PCDData data = pcd::PCDParser::parse(filepath);
-
-    // Create result object
-    Napi::Object result = Napi::Object::New(env);
-
-    // Header info
-    Napi::Object header = Napi::Object::New(env);
-    header.Set("version", data.header.version);
-    header.Set("width", data.header.width);
-    header.Set("height", data.header.height);
-    header.Set("points", static_cast<int>(data.numPoints()));
-    header.Set("dataType", data.header.dataType);
-
-    // Field names, types, and sizes
-    Napi::Array fieldNames = Napi::Array::New(env, data.header.fields.size());
-    Napi::Array fieldTypes = Napi::Array::New(env, data.header.fields.size());
-    Napi::Array fieldSizes = Napi::Array::New(env, data.header.fields.size());
-    for (size_t i = 0; i < data.header.fields.size(); i++) {
-      fieldNames[i] = Napi::String::New(env, data.header.fields[i].name);
-      fieldTypes[i] =
-          Napi::String::New(env, std::string(1, data.header.fields[i].type));
-      fieldSizes[i] = Napi::Number::New(env, data.header.fields[i].size);
-    }
-    header.Set("fields", fieldNames);
-    header.Set("fieldTypes", fieldTypes);
-    header.Set("fieldSizes", fieldSizes);
-    result.Set("header", header);
-
-    // Positions as Float32Array (interleaved x,y,z)
-    auto positions = data.getPositions();
-    Napi::Float32Array posArr = Napi::Float32Array::New(env, positions.size());
-    for (size_t i = 0; i < positions.size(); i++) {
-      posArr[i] = positions[i];
-    }
-    result.Set("positions", posArr);
+    return CloudToObject(env, DecodeCloud(filepath, options));
+  } catch (const std::exception &e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
 
-    // Labels as Uint32Array
-    auto labels = data.getLabels();
-    Napi::Uint32Array labelsArr = Napi::Uint32Array::New(env, labels.size());
-    for (size_t i = 0; i < labels.size(); i++) {
-      labelsArr[i] = labels[i];
-    }
-    result.Set("labels", labelsArr);
-
-    // All fields as named Float32Arrays (for colorization)
-    Napi::Object fields = Napi::Object::New(env);
-    for (size_t i = 0; i < data.header.fields.size(); i++) {
-      const std::string &name = data.header.fields[i].name;
-      auto fieldData = data.getFieldAsFloat(static_cast<int>(i));
-      Napi::Float32Array arr = Napi::Float32Array::New(env, fieldData.size());
-      for (size_t j = 0; j < fieldData.size(); j++) {
-        arr[j] = fieldData[j];
-      }
-      fields.Set(name, arr);
-    }
+// Read a PCD header without decoding any point data
+Napi::Value ProbePCD(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
 
-    // Add synthetic _color field if RGB data is available
-    // This contains interleaved r,g,b floats (normalized 0-1) for color
-    // interpretation The raw rgb/rgba fields remain as scalars above
-    if (data.hasRGB()) {
-      auto rgb = data.getRGB();
-      Napi::Float32Array colorArr = Napi::Float32Array::New(env, rgb.size());
-      for (size_t i = 0; i < rgb.size(); i++) {
-        colorArr[i] = rgb[i];
-      }
-      fields.Set("_color", colorArr);
-    }
-    result.Set("fields", fields);
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String filepath expected")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    return result;
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+
+  try {
+    pcd::PCDFileInfo fileInfo = pcd::PCDParser::probe(filepath);
+
+    Napi::Object header =
+        HeaderToObject(env, fileInfo.header, fileInfo.header.points);
+    header.Set("hasLabel", fileInfo.header.findField("label") >= 0);
+    header.Set("dataOffset", static_cast<double>(fileInfo.dataOffset));
+    header.Set("dataSize", static_cast<double>(fileInfo.dataSize));
+    header.Set("fileSize", static_cast<double>(fileInfo.fileSize));
+    return header;
 
   } catch (const std::exception &e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
@@ -91,6 +259,56 @@ Napi::Value ParsePCD(const Napi::CallbackInfo &info) {
   }
 }
 
+// Decode a single field, skipping the bytes of every other column
+static pcd::FieldData DecodeField(const std::string &filepath,
+                                  const std::string &name, double voxel = 0) {
+  pcd::ParseOptions options;
+  options.fields = {name};
+  std::shared_ptr<const pcd::PCDData> data = cloudCache.get(filepath, options);
+  int idx = data->header.findField(name);
+  if (idx < 0) {
+    throw std::runtime_error("Field not found: " + name);
+  }
+  if (voxel <= 0) {
+    return data->fieldData[idx];
+  }
+
+  // Values of the voxel representatives, matching a voxel preview parse
+  std::vector<uint32_t> picked =
+      CachedVoxelGrid(filepath, voxel).representatives;
+  return std::visit(
+      [&picked](const auto &vec) -> pcd::FieldData {
+        using T = typename std::decay_t<decltype(vec)>::value_type;
+        std::vector<T> values;
+        values.reserve(picked.size());
+        for (uint32_t i : picked)
+          values.push_back(i < vec.size() ? vec[i] : T{});
+        return values;
+      },
+      data->fieldData[idx]);
+}
+
+// getField(filepath, name) -> TypedArray of the field's native type
+Napi::Value GetField(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected filepath and field name")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::string name = info[1].As<Napi::String>().Utf8Value();
+
+  try {
+    return ColumnToTypedArray(env, DecodeField(filepath, name));
+  } catch (const std::exception &e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
 // Update labels in an existing PCD file
 Napi::Value UpdateLabels(const Napi::CallbackInfo &info) {
   Napi::Env env = info.Env();
@@ -113,6 +331,7 @@ Napi::Value UpdateLabels(const Napi::CallbackInfo &info) {
     }
 
     pcd::PCDParser::updateLabels(filepath, labels, binary);
+    cloudCache.invalidate(filepath);
 
     return Napi::Boolean::New(env, true);
 
@@ -143,6 +362,7 @@ Napi::Value UpdateLabelsWithFormat(const Napi::CallbackInfo &info) {
     }
 
     pcd::PCDParser::updateLabelsWithFormat(filepath, labels, format);
+    cloudCache.invalidate(filepath);
 
     return Napi::Boolean::New(env, true);
 
@@ -194,6 +414,7 @@ Napi::Value WritePCD(const Napi::CallbackInfo &info) {
     data.fieldData.push_back(std::move(labels));
 
     pcd::PCDParser::write(filepath, data, binary);
+    cloudCache.invalidate(filepath);
 
     return Napi::Boolean::New(env, true);
 
@@ -218,6 +439,7 @@ Napi::Value ConvertFormat(const Napi::CallbackInfo &info) {
 
   try {
     pcd::PCDParser::convertFormat(filepath, toBinary);
+    cloudCache.invalidate(filepath);
     return Napi::Boolean::New(env, true);
   } catch (const std::exception &e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
@@ -225,13 +447,722 @@ Napi::Value ConvertFormat(const Napi::CallbackInfo &info) {
   }
 }
 
+// Runs `work` on the libuv thread pool and settles a promise with the value
+// built by `done` on the main thread. Exceptions from `work` reject it.
+class PromiseWorker : public Napi::AsyncWorker {
+public:
+  using Work = std::function<void()>;
+  using Done = std::function<Napi::Value(Napi::Env)>;
+
+  PromiseWorker(Napi::Env env, Work work, Done done)
+      : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)),
+        work_(std::move(work)), done_(std::move(done)) {}
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    try {
+      work_();
+    } catch (const std::exception &e) {
+      SetError(e.what());
+    }
+  }
+
+  void OnOK() override { deferred_.Resolve(done_(Env())); }
+
+  void OnError(const Napi::Error &error) override {
+    deferred_.Reject(error.Value());
+  }
+
+private:
+  Napi::Promise::Deferred deferred_;
+  Work work_;
+  Done done_;
+};
+
+// Queue a PromiseWorker and return its promise
+static Napi::Value RunAsync(Napi::Env env, PromiseWorker::Work work,
+                            PromiseWorker::Done done) {
+  auto *worker = new PromiseWorker(env, std::move(work), std::move(done));
+  Napi::Promise promise = worker->Promise();
+  worker->Queue(); // Deleted by N-API after completion
+  return promise;
+}
+
+// Reject with a TypeError without throwing synchronously
+static Napi::Value RejectedPromise(Napi::Env env, const char *message) {
+  auto deferred = Napi::Promise::Deferred::New(env);
+  deferred.Reject(Napi::TypeError::New(env, message).Value());
+  return deferred.Promise();
+}
+
+// Copy a labels argument so worker threads never touch JavaScript memory
+static std::vector<uint32_t> CopyLabels(const Napi::Value &value) {
+  Napi::Uint32Array labelsArr = value.As<Napi::Uint32Array>();
+  std::vector<uint32_t> labels(labelsArr.ElementLength());
+  if (!labels.empty()) {
+    std::memcpy(labels.data(), labelsArr.Data(),
+                labels.size() * sizeof(uint32_t));
+  }
+  return labels;
+}
+
+// parseAsync(filepath, options?) -> Promise<parse() result>
+// File I/O and decoding run off the main thread; the JavaScript object is
+// built when the promise settles. options.voxel (leaf size) returns one
+// representative per voxel, with result.voxel = { size, sourcePoints,
+// indices } mapping them back to original points.
+Napi::Value ParsePCDAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    return RejectedPromise(env, "String filepath expected");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  pcd::ParseOptions options = ReadParseOptions(info, 1);
+  double voxel = ReadVoxelSize(info, 1);
+  auto cloud = std::make_shared<DecodedCloud>();
+
+  return RunAsync(
+      env,
+      [filepath, options, voxel, cloud]() {
+        *cloud = DecodeCloud(filepath, options, voxel);
+      },
+      [cloud](Napi::Env env) -> Napi::Value {
+        return CloudToObject(env, std::move(*cloud));
+      });
+}
+
+// updateLabelsAsync(filepath, labels, format?) -> Promise<true>
+// An empty or missing format preserves the file's current format
+Napi::Value UpdateLabelsAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray()) {
+    return RejectedPromise(env, "Expected filepath and labels");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::vector<uint32_t> labels = CopyLabels(info[1]);
+  std::string format = info.Length() > 2 && info[2].IsString()
+                           ? info[2].As<Napi::String>().Utf8Value()
+                           : "";
+
+  return RunAsync(
+      env,
+      [filepath, labels = std::move(labels), format]() {
+        pcd::PCDParser::updateLabelsWithFormat(filepath, labels, format);
+        cloudCache.invalidate(filepath);
+      },
+      [](Napi::Env env) -> Napi::Value { return Napi::Boolean::New(env, true); });
+}
+
+// applyLabelDeltaAsync(filepath, runs, format?, options?) -> Promise<true>
+// runs is a Uint32Array of (start, count, label) triples applied on top of
+// the file's current labels; an empty or missing format keeps the file's
+// format. With options.voxel the runs index a voxel preview's points and are
+// expanded to every point of their voxels.
+Napi::Value ApplyLabelDeltaAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray()) {
+    return RejectedPromise(env, "Expected filepath and label runs");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::vector<uint32_t> flat = CopyLabels(info[1]);
+  if (flat.size() % 3 != 0) {
+    return RejectedPromise(env, "Label runs must be (start, count, label) triples");
+  }
+  std::vector<pcd::LabelRun> runs(flat.size() / 3);
+  for (size_t i = 0; i < runs.size(); i++) {
+    runs[i].start = flat[i * 3];
+    runs[i].count = flat[i * 3 + 1];
+    runs[i].label = flat[i * 3 + 2];
+  }
+  std::string format = info.Length() > 2 && info[2].IsString()
+                           ? info[2].As<Napi::String>().Utf8Value()
+                           : "";
+  double voxel = ReadVoxelSize(info, 3);
+
+  return RunAsync(
+      env,
+      [filepath, runs = std::move(runs), format, voxel]() {
+        if (voxel > 0) {
+          // Runs over a voxel preview's points reach every member point
+          pcd::VoxelGrid grid = CachedVoxelGrid(filepath, voxel);
+          pcd::PCDParser::applyLabelDelta(filepath, grid.expand(runs), format);
+        } else {
+          pcd::PCDParser::applyLabelDelta(filepath, runs, format);
+        }
+        cloudCache.invalidate(filepath);
+      },
+      [](Napi::Env env) -> Napi::Value { return Napi::Boolean::New(env, true); });
+}
+
+// convertFormatAsync(filepath, format) -> Promise<true>
+// format is "ascii", "binary" or "binary_compressed" (or a toBinary boolean)
+Napi::Value ConvertFormatAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() ||
+      !(info[1].IsString() || info[1].IsBoolean())) {
+    return RejectedPromise(env, "Expected filepath and target format");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::string format = info[1].IsString()
+                           ? info[1].As<Napi::String>().Utf8Value()
+                           : (info[1].As<Napi::Boolean>().Value() ? "binary"
+                                                                  : "ascii");
+
+  return RunAsync(
+      env,
+      [filepath, format]() {
+        pcd::PCDParser::convertFormat(filepath, format);
+        cloudCache.invalidate(filepath);
+      },
+      [](Napi::Env env) -> Napi::Value { return Napi::Boolean::New(env, true); });
+}
+
+// getFieldAsync(filepath, name, options?) -> Promise<TypedArray>
+// options.voxel returns the values of a voxel preview's points
+Napi::Value GetFieldAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+    return RejectedPromise(env, "Expected filepath and field name");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::string name = info[1].As<Napi::String>().Utf8Value();
+  double voxel = ReadVoxelSize(info, 2);
+  auto column = std::make_shared<pcd::FieldData>();
+
+  return RunAsync(
+      env,
+      [filepath, name, voxel, column]() {
+        *column = DecodeField(filepath, name, voxel);
+      },
+      [column](Napi::Env env) -> Napi::Value {
+        return ColumnToTypedArray(env, std::move(*column));
+      });
+}
+
+// setCacheBudget(megabytes) -> undefined
+// Shrinking the budget evicts immediately; 0 disables caching
+Napi::Value SetCacheBudget(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected budget in megabytes")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  double megabytes = info[0].As<Napi::Number>().DoubleValue();
+  cloudCache.setBudget(
+      megabytes > 0 ? static_cast<size_t>(megabytes * 1024 * 1024) : 0);
+  return env.Undefined();
+}
+
+// cacheStats() -> { entries, bytes, budget, hits, misses }
+Napi::Value CacheStats(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  pcd::PCDCache::Stats stats = cloudCache.stats();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("entries", Napi::Number::New(env, static_cast<double>(stats.entries)));
+  result.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes)));
+  result.Set("budget", Napi::Number::New(env, static_cast<double>(stats.budget)));
+  result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+  result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+  return result;
+}
+
+// prefetch(paths, options?) -> undefined
+// Parse `paths` in order on background threads into the cache, replacing
+// any prefetches not yet started. Options are as for parse(); requests must
+// use the same fields to hit the prefetched entries.
+Napi::Value Prefetch(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected array of file paths")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array pathsArr = info[0].As<Napi::Array>();
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < pathsArr.Length(); i++) {
+    Napi::Value path = pathsArr.Get(i);
+    if (path.IsString())
+      paths.push_back(path.As<Napi::String>().Utf8Value());
+  }
+  pcd::ParseOptions options = ReadParseOptions(info, 1);
+
+  if (!prefetcher) {
+    prefetcher = std::make_unique<pcd::PCDPrefetcher>(cloudCache);
+  }
+  prefetcher->schedule(paths, options);
+  return env.Undefined();
+}
+
+// cancelPrefetch() -> undefined
+// Drops queued prefetches; parses already running still finish
+Napi::Value CancelPrefetch(const Napi::CallbackInfo &info) {
+  if (prefetcher) {
+    prefetcher->cancel();
+  }
+  return info.Env().Undefined();
+}
+
+// Listing metadata of a scanned file: { points, fields, dataType, hasLabel,
+// fileSize }, or null when its header could not be read
+static Napi::Value ScannedFileMeta(Napi::Env env, const pcd::ScannedFile &file) {
+  if (!file.probed) {
+    return env.Null();
+  }
+  const pcd::PCDHeader &hdr = file.info.header;
+  Napi::Object meta = Napi::Object::New(env);
+  meta.Set("points", hdr.points);
+  Napi::Array fields = Napi::Array::New(env, hdr.fields.size());
+  for (size_t i = 0; i < hdr.fields.size(); i++) {
+    fields[i] = Napi::String::New(env, hdr.fields[i].name);
+  }
+  meta.Set("fields", fields);
+  meta.Set("dataType", hdr.dataType);
+  meta.Set("hasLabel", hdr.findField("label") >= 0);
+  meta.Set("fileSize", static_cast<double>(file.info.fileSize));
+  return meta;
+}
+
+// scanDirectoryAsync(root, { threads, recursive, probe }?)
+//   -> Promise<{ directories, files, meta? }>
+// directories and files are sorted paths relative to root; with probe, meta
+// holds ScannedFileMeta() per file
+Napi::Value ScanDirectoryAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    return RejectedPromise(env, "String directory path expected");
+  }
+
+  std::string root = info[0].As<Napi::String>().Utf8Value();
+  pcd::ScanOptions options;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object opts = info[1].As<Napi::Object>();
+    if (opts.Has("threads") && opts.Get("threads").IsNumber()) {
+      int threads = opts.Get("threads").As<Napi::Number>().Int32Value();
+      if (threads > 0)
+        options.threads = static_cast<unsigned>(threads);
+    }
+    if (opts.Has("recursive") && opts.Get("recursive").IsBoolean())
+      options.recursive = opts.Get("recursive").As<Napi::Boolean>().Value();
+    if (opts.Has("probe") && opts.Get("probe").IsBoolean())
+      options.probe = opts.Get("probe").As<Napi::Boolean>().Value();
+  }
+  auto result = std::make_shared<pcd::ScanResult>();
+
+  return RunAsync(
+      env, [root, options, result]() { *result = pcd::PCDScanner::scan(root, options); },
+      [result, probe = options.probe](Napi::Env env) -> Napi::Value {
+        Napi::Object out = Napi::Object::New(env);
+        Napi::Array directories = Napi::Array::New(env, result->directories.size());
+        for (size_t i = 0; i < result->directories.size(); i++) {
+          directories[i] = Napi::String::New(env, result->directories[i]);
+        }
+        Napi::Array files = Napi::Array::New(env, result->files.size());
+        for (size_t i = 0; i < result->files.size(); i++) {
+          files[i] = Napi::String::New(env, result->files[i].path);
+        }
+        out.Set("directories", directories);
+        out.Set("files", files);
+        if (probe) {
+          Napi::Array meta = Napi::Array::New(env, result->files.size());
+          for (size_t i = 0; i < result->files.size(); i++) {
+            meta[i] = ScannedFileMeta(env, result->files[i]);
+          }
+          out.Set("meta", meta);
+        }
+        return out;
+      });
+}
+
+// probeFilesAsync(paths) -> Promise<Array<meta | null>>
+// Reads the headers of many files in parallel (see ScannedFileMeta)
+Napi::Value ProbeFilesAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    return RejectedPromise(env, "Expected array of file paths");
+  }
+
+  Napi::Array pathsArr = info[0].As<Napi::Array>();
+  auto files = std::make_shared<std::vector<pcd::ScannedFile>>(pathsArr.Length());
+  for (uint32_t i = 0; i < pathsArr.Length(); i++) {
+    Napi::Value path = pathsArr.Get(i);
+    if (path.IsString())
+      (*files)[i].path = path.As<Napi::String>().Utf8Value();
+  }
+
+  return RunAsync(
+      env, [files]() { pcd::PCDScanner::probe("", *files); },
+      [files](Napi::Env env) -> Napi::Value {
+        Napi::Array meta = Napi::Array::New(env, files->size());
+        for (size_t i = 0; i < files->size(); i++) {
+          meta[i] = ScannedFileMeta(env, (*files)[i]);
+        }
+        return meta;
+      });
+}
+
+// Read a [x, y, z] array argument
+static bool ReadVec3(const Napi::Value &value, float out[3]) {
+  if (!value.IsArray())
+    return false;
+  Napi::Array arr = value.As<Napi::Array>();
+  if (arr.Length() != 3)
+    return false;
+  for (uint32_t a = 0; a < 3; a++) {
+    Napi::Value v = arr.Get(a);
+    if (!v.IsNumber())
+      return false;
+    out[a] = v.As<Napi::Number>().FloatValue();
+  }
+  return true;
+}
+
+// buildOctreeAsync(filepath) -> Promise<{ points, nodes, depth, leafSize }>
+// Builds (or loads) the file's octree into the cache ahead of queries
+Napi::Value BuildOctreeAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    return RejectedPromise(env, "String filepath expected");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  auto tree = std::make_shared<std::shared_ptr<const pcd::Octree>>();
+
+  return RunAsync(
+      env, [filepath, tree]() { *tree = cloudCache.octree(filepath); },
+      [tree](Napi::Env env) -> Napi::Value {
+        const pcd::Octree &octree = **tree;
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("points", static_cast<double>(octree.numPoints()));
+        result.Set("nodes", static_cast<double>(octree.nodes().size()));
+        result.Set("depth", octree.depth());
+        result.Set("leafSize", octree.leafSize());
+        return result;
+      });
+}
+
+// queryBoxAsync(filepath, min, max) -> Promise<Uint32Array>
+// Indices of the points inside the box [min, max] (x, y, z arrays)
+Napi::Value QueryBoxAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  float min[3], max[3];
+  if (info.Length() < 3 || !info[0].IsString() || !ReadVec3(info[1], min) ||
+      !ReadVec3(info[2], max)) {
+    return RejectedPromise(env, "Expected filepath, min and max");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::array<float, 6> box = {min[0], min[1], min[2], max[0], max[1], max[2]};
+  auto indices = std::make_shared<std::vector<uint32_t>>();
+
+  return RunAsync(
+      env,
+      [filepath, box, indices]() {
+        cloudCache.octree(filepath)->queryBox(box.data(), box.data() + 3,
+                                              *indices);
+      },
+      [indices](Napi::Env env) -> Napi::Value {
+        return ExternalTypedArray(env, std::move(*indices));
+      });
+}
+
+// Read an array of numbers
+static bool ReadFloats(const Napi::Value &value, std::vector<float> &out) {
+  if (!value.IsArray())
+    return false;
+  Napi::Array arr = value.As<Napi::Array>();
+  out.resize(arr.Length());
+  for (uint32_t i = 0; i < arr.Length(); i++) {
+    Napi::Value v = arr.Get(i);
+    if (!v.IsNumber())
+      return false;
+    out[i] = v.As<Napi::Number>().FloatValue();
+  }
+  return true;
+}
+
+// selectPolygonAsync(filepath, matrix, viewport, polygon) -> Promise<Uint8Array>
+// Points whose screen projection falls inside the polygon, as a bitset (bit
+// i & 7 of byte i >> 3 for point i). matrix is the 16-element column-major
+// world-to-clip matrix, viewport [left, top, width, height] and polygon the
+// flattened [x0, y0, x1, y1, ...] vertices, all in the same pixel space.
+Napi::Value SelectPolygonAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  std::vector<float> matrix, viewport, polygon;
+  if (info.Length() < 4 || !info[0].IsString() ||
+      !ReadFloats(info[1], matrix) || !ReadFloats(info[2], viewport) ||
+      !ReadFloats(info[3], polygon) || matrix.size() != 16 ||
+      viewport.size() != 4 || polygon.size() % 2 != 0) {
+    return RejectedPromise(env,
+                           "Expected filepath, matrix, viewport and polygon");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  pcd::SelectionView view;
+  std::copy(matrix.begin(), matrix.end(), view.matrix);
+  view.left = viewport[0];
+  view.top = viewport[1];
+  view.width = viewport[2];
+  view.height = viewport[3];
+  std::vector<pcd::ScreenPoint> vertices;
+  for (size_t i = 0; i < polygon.size(); i += 2) {
+    vertices.push_back({polygon[i], polygon[i + 1]});
+  }
+  auto bits = std::make_shared<std::vector<uint8_t>>();
+
+  return RunAsync(
+      env,
+      [filepath, view, vertices, bits]() {
+        pcd::PolygonSelector selector(view, vertices);
+        pcd::ParseOptions positions;
+        positions.fields = {"x", "y", "z"};
+        size_t numPoints = cloudCache.get(filepath, positions)->numPoints();
+        *bits = selector.select(*cloudCache.octree(filepath), numPoints);
+      },
+      [bits](Napi::Env env) -> Napi::Value {
+        return ExternalTypedArray(env, std::move(*bits));
+      });
+}
+
+// Node data copied out of a LOD hierarchy for one response
+struct LodNodeData {
+  uint32_t id;
+  pcd::LodNode node;
+  std::vector<uint32_t> indices;
+  std::vector<float> positions;
+};
+
+// selectLodAsync(filepath, matrix, viewportHeight, options?)
+//   -> Promise<{ visible: Uint32Array, nodes: [...] }>
+// Level-of-detail nodes to draw for a camera (matrix is the 16-element
+// column-major world-to-clip matrix), parents first. options:
+// { errorPixels, pointBudget, known: [ids], positions: bool }. nodes holds
+// { id, level, spacing, min, max, indices, positions? } for each visible node
+// not listed in known; indices are the original point indices.
+Napi::Value SelectLodAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  std::vector<float> matrix;
+  if (info.Length() < 3 || !info[0].IsString() ||
+      !ReadFloats(info[1], matrix) || matrix.size() != 16 ||
+      !info[2].IsNumber()) {
+    return RejectedPromise(env,
+                           "Expected filepath, matrix and viewport height");
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  float viewportHeight = info[2].As<Napi::Number>().FloatValue();
+  pcd::LodQuery query;
+  std::vector<float> known;
+  bool withPositions = true;
+  if (info.Length() > 3 && info[3].IsObject()) {
+    Napi::Object opts = info[3].As<Napi::Object>();
+    if (opts.Get("errorPixels").IsNumber()) {
+      query.errorPixels =
+          opts.Get("errorPixels").As<Napi::Number>().FloatValue();
+    }
+    if (opts.Get("pointBudget").IsNumber()) {
+      double budget = opts.Get("pointBudget").As<Napi::Number>().DoubleValue();
+      query.pointBudget = budget > 0 ? static_cast<size_t>(budget) : 0;
+    }
+    if (opts.Has("known") && !ReadFloats(opts.Get("known"), known))
+      return RejectedPromise(env, "known must be an array of node ids");
+    if (opts.Get("positions").IsBoolean())
+      withPositions = opts.Get("positions").As<Napi::Boolean>().Value();
+  }
+
+  std::array<float, 16> view;
+  std::copy(matrix.begin(), matrix.end(), view.begin());
+  auto visible = std::make_shared<std::vector<uint32_t>>();
+  auto nodes = std::make_shared<std::vector<LodNodeData>>();
+
+  return RunAsync(
+      env,
+      [filepath, view, viewportHeight, query, known, withPositions, visible,
+       nodes]() {
+        std::shared_ptr<const pcd::LodHierarchy> lod = cloudCache.lod(filepath);
+        *visible = lod->select(view.data(), viewportHeight, query);
+        std::vector<bool> skip(lod->nodes().size(), false);
+        for (float id : known) {
+          if (id >= 0 && id < skip.size())
+            skip[static_cast<size_t>(id)] = true;
+        }
+        for (uint32_t id : *visible) {
+          if (skip[id])
+            continue;
+          const pcd::LodNode &node = lod->nodes()[id];
+          LodNodeData data{id, node, {}, {}};
+          auto first = lod->indices().begin() + node.first;
+          data.indices.assign(first, first + node.count);
+          if (withPositions) {
+            auto xyz = lod->positions().begin() + size_t(node.first) * 3;
+            data.positions.assign(xyz, xyz + size_t(node.count) * 3);
+          }
+          nodes->push_back(std::move(data));
+        }
+      },
+      [visible, nodes, withPositions](Napi::Env env) -> Napi::Value {
+        Napi::Array nodeArr = Napi::Array::New(env, nodes->size());
+        for (size_t i = 0; i < nodes->size(); i++) {
+          LodNodeData &data = (*nodes)[i];
+          Napi::Object obj = Napi::Object::New(env);
+          Napi::Array min = Napi::Array::New(env, 3);
+          Napi::Array max = Napi::Array::New(env, 3);
+          for (uint32_t a = 0; a < 3; a++) {
+            min[a] = Napi::Number::New(env, data.node.min[a]);
+            max[a] = Napi::Number::New(env, data.node.max[a]);
+          }
+          obj.Set("id", data.id);
+          obj.Set("level", static_cast<uint32_t>(data.node.level));
+          obj.Set("spacing", data.node.spacing);
+          obj.Set("min", min);
+          obj.Set("max", max);
+          obj.Set("indices", ExternalTypedArray(env, std::move(data.indices)));
+          if (withPositions) {
+            obj.Set("positions",
+                    ExternalTypedArray(env, std::move(data.positions)));
+          }
+          nodeArr[i] = obj;
+        }
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("visible", ExternalTypedArray(env, std::move(*visible)));
+        result.Set("nodes", nodeArr);
+        return result;
+      });
+}
+
+// smoothLabelsAsync(filepath, labels, mask?, options?) -> Promise<Uint32Array>
+// Majority-vote smoothing of a Uint32Array of per-point labels over the
+// cloud's nearest neighbours. mask is a Uint8Array bitset of the points to
+// update (bit i & 7 of byte i >> 3 for point i; null = all). options:
+// { k, radius, iterations, ignoreUnlabeled }. Returns the updated labels.
+Napi::Value SmoothLabelsAsync(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray() ||
+      info[1].As<Napi::TypedArray>().TypedArrayType() != napi_uint32_array) {
+    return RejectedPromise(env, "Expected filepath and Uint32Array labels");
+  }
+  std::vector<uint8_t> mask;
+  if (info.Length() > 2 && !info[2].IsNull() && !info[2].IsUndefined()) {
+    if (!info[2].IsTypedArray() ||
+        info[2].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+      return RejectedPromise(env, "mask must be a Uint8Array bitset");
+    }
+    Napi::Uint8Array bits = info[2].As<Napi::Uint8Array>();
+    mask.assign(bits.Data(), bits.Data() + bits.ElementLength());
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  std::vector<uint32_t> labels = CopyLabels(info[1]);
+  pcd::SmoothOptions options;
+  if (info.Length() > 3 && info[3].IsObject()) {
+    Napi::Object opts = info[3].As<Napi::Object>();
+    if (opts.Get("k").IsNumber()) {
+      double k = opts.Get("k").As<Napi::Number>().DoubleValue();
+      options.k = static_cast<uint32_t>(std::min(std::max(k, 1.0), 256.0));
+    }
+    if (opts.Get("radius").IsNumber())
+      options.radius = opts.Get("radius").As<Napi::Number>().FloatValue();
+    if (opts.Get("iterations").IsNumber()) {
+      double iterations =
+          opts.Get("iterations").As<Napi::Number>().DoubleValue();
+      options.iterations =
+          static_cast<uint32_t>(std::min(std::max(iterations, 0.0), 100.0));
+    }
+    if (opts.Get("ignoreUnlabeled").IsBoolean()) {
+      options.ignoreUnlabeled =
+          opts.Get("ignoreUnlabeled").As<Napi::Boolean>().Value();
+    }
+  }
+  auto result = std::make_shared<std::vector<uint32_t>>();
+
+  return RunAsync(
+      env,
+      [filepath, labels = std::move(labels), mask = std::move(mask), options,
+       result]() {
+        pcd::ParseOptions positions;
+        positions.fields = {"x", "y", "z"};
+        size_t numPoints = cloudCache.get(filepath, positions)->numPoints();
+        if (labels.size() != numPoints) {
+          throw std::runtime_error("Label count does not match the cloud");
+        }
+        *result = pcd::smoothLabels(*cloudCache.kdTree(filepath), labels, mask,
+                                    options);
+      },
+      [result](Napi::Env env) -> Napi::Value {
+        return ExternalTypedArray(env, std::move(*result));
+      });
+}
+
+// setOctreeCacheDir(directory) -> undefined
+// Octrees are saved there and reused across restarts ('' = memory only)
+Napi::Value SetOctreeCacheDir(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "String directory expected")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  cloudCache.setOctreeDirectory(info[0].As<Napi::String>().Utf8Value());
+  return env.Undefined();
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("parse", Napi::Function::New(env, ParsePCD));
+  exports.Set("probe", Napi::Function::New(env, ProbePCD));
+  exports.Set("getField", Napi::Function::New(env, GetField));
   exports.Set("write", Napi::Function::New(env, WritePCD));
   exports.Set("updateLabels", Napi::Function::New(env, UpdateLabels));
   exports.Set("updateLabelsWithFormat",
               Napi::Function::New(env, UpdateLabelsWithFormat));
   exports.Set("convertFormat", Napi::Function::New(env, ConvertFormat));
+  exports.Set("parseAsync", Napi::Function::New(env, ParsePCDAsync));
+  exports.Set("getFieldAsync", Napi::Function::New(env, GetFieldAsync));
+  exports.Set("updateLabelsAsync",
+              Napi::Function::New(env, UpdateLabelsAsync));
+  exports.Set("applyLabelDeltaAsync",
+              Napi::Function::New(env, ApplyLabelDeltaAsync));
+  exports.Set("convertFormatAsync",
+              Napi::Function::New(env, ConvertFormatAsync));
+  exports.Set("setCacheBudget", Napi::Function::New(env, SetCacheBudget));
+  exports.Set("cacheStats", Napi::Function::New(env, CacheStats));
+  exports.Set("prefetch", Napi::Function::New(env, Prefetch));
+  exports.Set("cancelPrefetch", Napi::Function::New(env, CancelPrefetch));
+  exports.Set("scanDirectoryAsync",
+              Napi::Function::New(env, ScanDirectoryAsync));
+  exports.Set("probeFilesAsync", Napi::Function::New(env, ProbeFilesAsync));
+  exports.Set("buildOctreeAsync", Napi::Function::New(env, BuildOctreeAsync));
+  exports.Set("queryBoxAsync", Napi::Function::New(env, QueryBoxAsync));
+  exports.Set("selectPolygonAsync",
+              Napi::Function::New(env, SelectPolygonAsync));
+  exports.Set("selectLodAsync", Napi::Function::New(env, SelectLodAsync));
+  exports.Set("smoothLabelsAsync",
+              Napi::Function::New(env, SmoothLabelsAsync));
+  exports.Set("setOctreeCacheDir", Napi::Function::New(env, SetOctreeCacheDir));
   return exports;
 }
 
@@ -0,0 +1,101 @@
+#ifndef PCD_KDTREE_H
+#define PCD_KDTREE_H
+
+#include "pcd_parser/octree.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pcd {
+
+struct KdTreeOptions {
+  uint32_t leafSize = 16; // Nodes with more points are split
+  unsigned threads = 0;   // Build threads (0 = all cores)
+};
+
+// Nodes are stored depth-first: the left child of an interior node follows
+// it directly
+struct KdNode {
+  float split;    // Points left of the split have coordinate <= split, the
+                  // ones right of it >= split
+  uint32_t first; // Range [first, first + count) of KdTree::order()
+  uint32_t count;
+  uint32_t right; // Index of the right child, 0 for leaves
+  uint8_t axis;   // 0, 1 or 2 for x, y or z
+  uint8_t reserved[3];
+};
+
+// Balanced kd-tree over a cloud's positions for nearest-neighbour queries.
+// Each node splits its points at the median of their widest axis; positions
+// are stored in tree order so leaves scan contiguous memory. Points with
+// non-finite coordinates are left out.
+class KdTree {
+public:
+  KdTree() = default;
+
+  // Build from separate x/y/z columns of n points
+  static KdTree build(const float *x, const float *y, const float *z,
+                      size_t n, const KdTreeOptions &options = {});
+  // Build from the (already gathered) positions of an octree
+  static KdTree build(const Octree &tree, const KdTreeOptions &options = {});
+
+  const std::vector<KdNode> &nodes() const { return nodes_; }
+  // Original point index of each point in tree order
+  const std::vector<uint32_t> &order() const { return order_; }
+  // x, y, z of each point in tree order
+  const std::vector<float> &positions() const { return positions_; }
+
+  size_t numPoints() const { return order_.size(); }
+  // Approximate memory held, for cache accounting
+  size_t bytes() const;
+
+  // Original indices of the k points nearest `point`, nearest first, and
+  // optionally their squared distances. Replaces the contents of `out`.
+  void knn(const float point[3], size_t k, std::vector<uint32_t> &out,
+           std::vector<float> *distancesSq = nullptr) const;
+  // Original indices of points within `radius` of `center` (inclusive),
+  // appended to `out` in tree order
+  void radius(const float center[3], float radius,
+              std::vector<uint32_t> &out) const;
+
+  // (squared distance, tree position) pairs of the up to k points nearest
+  // `point` within sqrt(maxDistanceSq), as an unordered max-heap
+  using Neighbour = std::pair<float, uint32_t>;
+  void nearest(const float point[3], size_t k, float maxDistanceSq,
+               std::vector<Neighbour> &heap) const;
+
+private:
+  // Build the nodes over order_/positions_, reordering them into tree order
+  void split(const KdTreeOptions &options);
+
+  std::vector<KdNode> nodes_;
+  std::vector<uint32_t> order_;
+  std::vector<float> positions_;
+};
+
+struct SmoothOptions {
+  uint32_t k = 8;       // Neighbours voting, the point itself included
+  float radius = 0;     // Ignore neighbours farther than this (0 = no limit)
+  uint32_t iterations = 1;
+  // Unlabeled (0) neighbours do not vote, so unlabeled points take the
+  // label of their labeled neighbours instead of staying unlabeled
+  bool ignoreUnlabeled = false;
+  unsigned threads = 0; // 0 = all cores
+};
+
+// Majority-vote label smoothing: each selected point takes the most common
+// label among its k nearest neighbours, keeping its own label on ties (the
+// smallest label otherwise). Every iteration reads the previous iteration's
+// labels only, so the result does not depend on the thread count.
+//
+// `labels` holds one label per original point. `mask` is a bitset of the
+// points to update (bit i & 7 of byte i >> 3 for point i; empty = all).
+// Returns the updated labels.
+std::vector<uint32_t> smoothLabels(const KdTree &tree,
+                                   const std::vector<uint32_t> &labels,
+                                   const std::vector<uint8_t> &mask,
+                                   const SmoothOptions &options = {});
+
+} // namespace pcd
+
+#endif // PCD_KDTREE_H
@@ -0,0 +1,72 @@
+#ifndef PCD_LOD_H
+#define PCD_LOD_H
+
+#include "pcd_parser/octree.h"
+#include <cstdint>
+#include <vector>
+
+namespace pcd {
+
+struct LodOptions {
+  uint32_t nodePoints = 16384; // Points sampled into each interior node
+  unsigned threads = 0;        // Build threads (0 = all cores)
+};
+
+// Nodes are stored breadth-first; the children of a node are contiguous
+struct LodNode {
+  float min[3];        // Bounds of the node's whole subtree
+  float max[3];
+  // Approximate distance between neighbouring points once this node and
+  // its ancestors are drawn (0 when the subtree has no more points)
+  float spacing;
+  uint32_t first;      // Range [first, first + count) of indices()/positions()
+  uint32_t count;
+  uint32_t firstChild; // Index of the first child in LodHierarchy::nodes()
+  uint8_t childCount;  // 0 for leaves
+  uint8_t level;       // 0 for the root
+  uint8_t reserved[2];
+};
+
+struct LodQuery {
+  float errorPixels = 1.5f;       // Refine nodes whose spacing projects larger
+  size_t pointBudget = 3000000;   // Stop once this many points are selected
+};
+
+// Multi-resolution hierarchy over an octree, in the style of Potree: every
+// point belongs to exactly one node, and each node holds an evenly spread
+// sample of the points its ancestors left out. Drawing a node together with
+// all of its ancestors shows its region at the node's spacing; drawing every
+// node shows the full cloud. indices() maps each node point back to its
+// original point index.
+class LodHierarchy {
+public:
+  LodHierarchy() = default;
+
+  static LodHierarchy build(const Octree &tree, const LodOptions &options = {});
+
+  const std::vector<LodNode> &nodes() const { return nodes_; }
+  // Original point index of each node point
+  const std::vector<uint32_t> &indices() const { return indices_; }
+  // x, y, z of each node point
+  const std::vector<float> &positions() const { return positions_; }
+
+  size_t numPoints() const { return indices_.size(); }
+  // Approximate memory held, for cache accounting
+  size_t bytes() const;
+
+  // Nodes to draw for a camera, given its column-major world-to-clip matrix
+  // and the viewport height in pixels. Nodes outside the view frustum are
+  // skipped and the largest projected spacing is refined first; the result
+  // lists parents before their children.
+  std::vector<uint32_t> select(const float matrix[16], float viewportHeight,
+                               const LodQuery &query = {}) const;
+
+private:
+  std::vector<LodNode> nodes_;
+  std::vector<uint32_t> indices_;
+  std::vector<float> positions_;
+};
+
+} // namespace pcd
+
+#endif // PCD_LOD_H
@@ -0,0 +1,40 @@
+#ifndef PCD_MAPPED_FILE_H
+#define PCD_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pcd {
+
+// RAII memory mapping of a whole file
+// Read-only mappings back the zero-copy parse paths; read-write mappings are
+// used to patch fixed-size values in place
+class MappedFile {
+public:
+  enum class Mode { ReadOnly, ReadWrite };
+
+  explicit MappedFile(const std::string &filepath,
+                      Mode mode = Mode::ReadOnly);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  const uint8_t *data() const { return data_; }
+  uint8_t *data() { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  void release();
+
+  uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  bool heapBacked_ = false; // Fallback when mmap is unavailable
+};
+
+} // namespace pcd
+
+#endif // PCD_MAPPED_FILE_H
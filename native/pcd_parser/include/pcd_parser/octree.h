@@ -0,0 +1,78 @@
+#ifndef PCD_OCTREE_H
+#define PCD_OCTREE_H
+
+#include "pcd_parser/pcd_parser.h"
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace pcd {
+
+struct OctreeOptions {
+  uint32_t leafSize = 64; // Nodes with more points are split
+  unsigned threads = 0;   // Build threads (0 = all cores)
+};
+
+// Nodes are stored breadth-first; the children of a node are contiguous
+struct OctreeNode {
+  float min[3];        // Tight bounds of the node's points
+  float max[3];
+  uint32_t first;      // Range [first, first + count) of Octree::order()
+  uint32_t count;
+  uint32_t firstChild; // Index of the first child in Octree::nodes()
+  uint8_t childCount;  // 0 for leaves
+  uint8_t level;       // 0 for the root
+  uint8_t reserved[2];
+};
+
+// Linear octree over a cloud's positions. Points are sorted by the Morton
+// code of their position quantized to the cloud's bounding cube (21 bits
+// per axis), so every node covers a contiguous range of the sorted points
+// and their positions are stored in that order for cache-friendly scans.
+// Points with non-finite coordinates are left out.
+class Octree {
+public:
+  static constexpr uint8_t kMaxLevel = 21;
+
+  Octree() = default;
+
+  // Build from separate x/y/z columns of n points
+  static Octree build(const float *x, const float *y, const float *z,
+                      size_t n, const OctreeOptions &options = {});
+  // Build from the x/y/z fields of a cloud (any numeric type)
+  static Octree build(const PCDData &data, const OctreeOptions &options = {});
+
+  const std::vector<OctreeNode> &nodes() const { return nodes_; }
+  // Original point index of each sorted point
+  const std::vector<uint32_t> &order() const { return order_; }
+  // x, y, z of each sorted point
+  const std::vector<float> &positions() const { return positions_; }
+
+  size_t numPoints() const { return order_.size(); }
+  uint32_t leafSize() const { return leafSize_; }
+  unsigned depth() const;
+  // Approximate memory held, for cache accounting
+  size_t bytes() const;
+
+  // Original indices of points inside the box / sphere (bounds inclusive),
+  // appended to `out` in Morton order
+  void queryBox(const float min[3], const float max[3],
+                std::vector<uint32_t> &out) const;
+  void queryRadius(const float center[3], float radius,
+                   std::vector<uint32_t> &out) const;
+
+  // Binary serialization in native byte order, for caching on the machine
+  // that built the tree. load() throws on malformed input.
+  void save(std::ostream &stream) const;
+  static Octree load(std::istream &stream);
+
+private:
+  std::vector<OctreeNode> nodes_;
+  std::vector<uint32_t> order_;
+  std::vector<float> positions_;
+  uint32_t leafSize_ = 0;
+};
+
+} // namespace pcd
+
+#endif // PCD_OCTREE_H
@@ -0,0 +1,93 @@
+#ifndef PCD_CACHE_H
+#define PCD_CACHE_H
+
+#include "pcd_parser/kdtree.h"
+#include "pcd_parser/lod.h"
+#include "pcd_parser/octree.h"
+#include "pcd_parser/pcd_parser.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pcd {
+
+// Thread-safe LRU cache of parsed clouds with a byte budget.
+// Entries are keyed by path and revalidated against the file's modification
+// time and size on every lookup. Fields can be decoded incrementally: a
+// request for fields an entry does not hold yet decodes only those and
+// merges them into the entry.
+class PCDCache {
+public:
+  explicit PCDCache(size_t budgetBytes);
+
+  // Parsed contents of `filepath` holding at least options.fields (all
+  // fields when empty). Misses parse the file; the returned data stays valid
+  // after eviction.
+  std::shared_ptr<const PCDData> get(const std::string &filepath,
+                                     const ParseOptions &options = {});
+
+  // Octree over the cloud's positions, built on first use and kept with its
+  // entry (the tree's bytes count toward the budget)
+  std::shared_ptr<const Octree> octree(const std::string &filepath);
+
+  // Level-of-detail hierarchy built from the octree, kept the same way
+  std::shared_ptr<const LodHierarchy> lod(const std::string &filepath);
+
+  // Kd-tree for neighbour queries, built from the octree's positions and
+  // kept the same way
+  std::shared_ptr<const KdTree> kdTree(const std::string &filepath);
+
+  // Directory where octrees are also saved and reloaded across runs,
+  // validated by the file's path, modification time and size (empty = off)
+  void setOctreeDirectory(const std::string &directory);
+
+  // Drop the entry for `filepath` (call after writing the file)
+  void invalidate(const std::string &filepath);
+  void clear();
+
+  // Shrinking the budget evicts least recently used entries
+  void setBudget(size_t budgetBytes);
+
+  struct Stats {
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t budget = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+  Stats stats() const;
+
+private:
+  struct Entry {
+    std::string path;
+    int64_t mtime = 0;
+    uintmax_t fileSize = 0;
+    std::shared_ptr<const PCDData> data;
+    std::vector<bool> decoded; // Per header field
+    std::shared_ptr<const Octree> octree;
+    std::shared_ptr<const LodHierarchy> lod;
+    std::shared_ptr<const KdTree> kdTree;
+    size_t bytes = 0;
+  };
+  using EntryList = std::list<Entry>;
+
+  void evictLocked();
+  void eraseLocked(EntryList::iterator it);
+
+  mutable std::mutex mutex_;
+  EntryList entries_; // Most recently used first
+  std::unordered_map<std::string, EntryList::iterator> index_;
+  std::string octreeDirectory_;
+  size_t budget_;
+  size_t bytes_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+} // namespace pcd
+
+#endif // PCD_CACHE_H
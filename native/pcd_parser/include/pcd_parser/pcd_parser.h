@@ -61,6 +61,19 @@ struct FieldInfo {
     }
     return std::vector<float>{}; // Default fallback
   }
+
+  // True when createStorage() yields the on-disk element type (unsupported
+  // type/size combinations fall back to float and are not decoded)
+  bool isSupported() const {
+    switch (type) {
+    case 'I':
+    case 'U':
+      return size == 1 || size == 2 || size == 4;
+    case 'F':
+      return size == 4 || size == 8;
+    }
+    return false;
+  }
 };
 
 // PCD file header
@@ -119,10 +132,15 @@ struct PCDData {
   PCDHeader header;
   std::vector<FieldData> fieldData; // One entry per field in header
 
+  // Length of the longest column (fields skipped by a ParseOptions field
+  // subset are left empty)
   size_t numPoints() const {
-    if (fieldData.empty())
-      return 0;
-    return std::visit([](const auto &vec) { return vec.size(); }, fieldData[0]);
+    size_t count = 0;
+    for (const auto &column : fieldData) {
+      count = std::max(
+          count, std::visit([](const auto &vec) { return vec.size(); }, column));
+    }
+    return count;
   }
 
   // Get field data by name, converted to doubles for uniform processing
@@ -316,10 +334,54 @@ struct PCDData {
   }
 };
 
+// Header-level description of a PCD file, read without decoding points
+struct PCDFileInfo {
+  PCDHeader header;
+  size_t dataOffset = 0; // Byte offset of the data section
+  size_t dataSize = 0;   // Bytes from dataOffset to the end of the file
+  size_t fileSize = 0;
+};
+
+// Consecutive points [start, start + count) set to one label
+struct LabelRun {
+  uint32_t start = 0;
+  uint32_t count = 0;
+  uint32_t label = 0;
+};
+
+// Result of PCDParser::voxelGrid
+struct VoxelGrid {
+  static constexpr uint32_t kNoVoxel = 0xffffffffu;
+
+  // Original index of each voxel's representative point (the one nearest
+  // the voxel's center), ascending; voxel v is represented by point
+  // representatives[v]
+  std::vector<uint32_t> representatives;
+  // Voxel of each original point (kNoVoxel for non-finite positions)
+  std::vector<uint32_t> voxelOf;
+
+  // Label runs over voxels as runs over every member point. Throws if a run
+  // extends past the last voxel.
+  std::vector<LabelRun> expand(const std::vector<LabelRun> &voxelRuns) const;
+};
+
+// Options for PCDParser::parse
+struct ParseOptions {
+  unsigned threads = 0; // Worker threads for ascii data (0 = all cores)
+  // Fields to decode (case-insensitive; empty = all). Other fields keep
+  // their header entry but get an empty column.
+  std::vector<std::string> fields;
+};
+
 class PCDParser {
 public:
   // Parse a PCD file
   static PCDData parse(const std::string &filepath);
+  static PCDData parse(const std::string &filepath,
+                       const ParseOptions &options);
+
+  // Read only the header and data section location of a PCD file
+  static PCDFileInfo probe(const std::string &filepath);
 
   // Write PCD data to file
   static void write(const std::string &filepath, const PCDData &data,
@@ -335,18 +397,58 @@ public:
                                      const std::vector<uint32_t> &labels,
                                      const std::string &format);
 
+  // Overwrite the label column of a DATA binary file in place. Only applies
+  // when the file already has a 4-byte, single-count I/U label field and one
+  // label per point; returns false (file untouched) otherwise.
+  static bool patchLabels(const std::string &filepath,
+                          const std::vector<uint32_t> &labels);
+
+  // Apply label runs on top of the file's current labels. Where patchLabels
+  // would apply, only the runs' records are written in place; otherwise the
+  // file is rewritten in `format` (empty = keep). Throws if a run extends
+  // past the last point.
+  static void applyLabelDelta(const std::string &filepath,
+                              const std::vector<LabelRun> &runs,
+                              const std::string &format = "");
+
+  // Voxel grid filter: one representative per occupied cube of `leafSize`
+  // over the x, y and z fields (any numeric type). Points are grouped in
+  // parallel through hashed buckets; the result depends only on the cloud
+  // and leaf size. Throws if the fields are missing or the grid would
+  // exceed 2^21 cells along an axis.
+  static VoxelGrid voxelGrid(const PCDData &data, double leafSize,
+                             unsigned threads = 0);
+
+  // The points `indices` of `data` as a new cloud (columns not decoded in
+  // `data` stay empty)
+  static PCDData subset(const PCDData &data,
+                        const std::vector<uint32_t> &indices);
+
   // Convert file format (ascii <-> binary <-> binary_compressed)
   static void convertFormat(const std::string &filepath, bool toBinary);
   static void convertFormat(const std::string &filepath,
                             const std::string &format);
 
 private:
+  friend class PCDReader;
+  friend class PCDWriter;
+
   static PCDHeader parseHeader(std::istream &stream);
   static std::vector<std::string> splitString(const std::string &str,
                                               char delim = ' ');
-  static void parseAsciiData(std::istream &stream, PCDData &data);
-  static void parseBinaryData(std::istream &stream, PCDData &data);
-  static void parseBinaryCompressedData(std::istream &stream, PCDData &data);
+  static std::vector<bool> selectFields(const PCDHeader &header,
+                                        const ParseOptions &options);
+  static void parseAsciiData(const char *begin, const char *end,
+                             PCDData &data, unsigned threads,
+                             const std::vector<bool> &decode);
+  static void parseBinaryData(const uint8_t *begin, size_t size,
+                              PCDData &data, const std::vector<bool> &decode);
+  static void parseBinaryCompressedData(const uint8_t *begin, size_t size,
+                                        PCDData &data,
+                                        const std::vector<bool> &decode);
+  static void writeHeader(std::ostream &stream, const PCDHeader &header,
+                          const std::string &pointCount,
+                          const std::string &format);
   static void writeAscii(std::ostream &stream, const PCDData &data);
   static void writeBinary(std::ostream &stream, const PCDData &data);
   static void writeBinaryCompressed(std::ostream &stream, const PCDData &data);
@@ -0,0 +1,56 @@
+#ifndef PCD_PREFETCHER_H
+#define PCD_PREFETCHER_H
+
+#include "pcd_parser/pcd_cache.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pcd {
+
+// Background workers that speculatively parse files into a PCDCache, e.g.
+// the frames around the one being viewed. Each schedule() replaces the
+// pending queue, so jumping elsewhere cancels prefetches that have not
+// started; parses already running finish into the cache. Errors are ignored
+// (the foreground request will report them).
+class PCDPrefetcher {
+public:
+  explicit PCDPrefetcher(PCDCache &cache, unsigned threads = 2);
+  ~PCDPrefetcher();
+
+  PCDPrefetcher(const PCDPrefetcher &) = delete;
+  PCDPrefetcher &operator=(const PCDPrefetcher &) = delete;
+
+  // Replace pending work with `paths`, parsed in order with `options`
+  void schedule(const std::vector<std::string> &paths,
+                const ParseOptions &options = {});
+
+  // Drop pending work
+  void cancel();
+
+  // Block until the queue is empty and no parse is running
+  void wait();
+
+  // Paths still queued
+  size_t pending() const;
+
+private:
+  void run();
+
+  PCDCache &cache_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  std::deque<std::string> queue_;
+  ParseOptions options_;
+  unsigned active_ = 0;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace pcd
+
+#endif // PCD_PREFETCHER_H
@@ -0,0 +1,66 @@
+#ifndef PCD_READER_H
+#define PCD_READER_H
+
+#include "pcd_parser/pcd_parser.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pcd {
+
+// Sequential PCD reader that decodes a file in fixed-size point chunks, so
+// clouds larger than memory can be processed one slice at a time.
+// Chunks use the same column types as PCDParser::parse().
+class PCDReader {
+public:
+  static constexpr size_t kDefaultChunkPoints = 1 << 20;
+
+  explicit PCDReader(const std::string &filepath,
+                     size_t chunkPoints = kDefaultChunkPoints);
+  ~PCDReader();
+
+  PCDReader(const PCDReader &) = delete;
+  PCDReader &operator=(const PCDReader &) = delete;
+
+  const PCDHeader &header() const { return header_; }
+
+  // Points returned by next() so far
+  size_t pointsRead() const { return pointsRead_; }
+
+  // Decode up to chunkPoints points into `chunk` (header plus one column per
+  // field). Returns false once the data section is exhausted.
+  bool next(PCDData &chunk);
+
+private:
+  size_t readAscii(std::vector<FieldData> &columns);
+  size_t readBinary(std::vector<FieldData> &columns);
+  size_t readCompressed(std::vector<FieldData> &columns);
+  void spillCompressed();
+
+  std::string filepath_;
+  PCDHeader header_;
+  size_t chunkPoints_;
+  size_t pointsRead_ = 0;
+  size_t totalPoints_ = 0; // Declared POINTS (binary formats)
+  std::streamoff dataOffset_ = 0;
+  std::ifstream file_;
+
+  // ascii: unconsumed text starting at textPos_
+  std::string text_;
+  size_t textPos_ = 0;
+  bool textEof_ = false;
+
+  // binary: one chunk of raw records
+  std::vector<uint8_t> records_;
+
+  // binary_compressed: the column-major payload decompressed into a
+  // temporary file, read back one column slice at a time
+  std::string spillPath_;
+  std::fstream spill_;
+  std::vector<std::streamoff> columnOffsets_;
+  std::vector<uint8_t> staging_;
+};
+
+} // namespace pcd
+
+#endif // PCD_READER_H
@@ -0,0 +1,46 @@
+#ifndef PCD_SCANNER_H
+#define PCD_SCANNER_H
+
+#include "pcd_parser/pcd_parser.h"
+#include <string>
+#include <vector>
+
+namespace pcd {
+
+// Options for PCDScanner::scan
+struct ScanOptions {
+  // Worker threads. Listing is latency-bound (network filesystems), so the
+  // default exceeds the core count.
+  unsigned threads = 16;
+  bool recursive = true;
+  bool probe = false; // Read each file's header
+};
+
+struct ScannedFile {
+  std::string path;    // Relative to the scan root, '/'-separated
+  bool probed = false; // info is valid (header read successfully)
+  PCDFileInfo info;
+};
+
+struct ScanResult {
+  std::vector<std::string> directories; // Relative, sorted; root excluded
+  std::vector<ScannedFile> files;       // Sorted by path
+};
+
+// Parallel enumeration of .pcd files under a directory. Hidden entries
+// (leading '.') are skipped and directory symlinks are not followed;
+// unreadable directories are skipped silently.
+class PCDScanner {
+public:
+  static ScanResult scan(const std::string &root,
+                         const ScanOptions &options = {});
+
+  // Probe headers of files relative to `root` in parallel. Files whose
+  // header cannot be read are left with probed = false.
+  static void probe(const std::string &root, std::vector<ScannedFile> &files,
+                    unsigned threads = ScanOptions().threads);
+};
+
+} // namespace pcd
+
+#endif // PCD_SCANNER_H
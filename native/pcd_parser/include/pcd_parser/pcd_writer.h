@@ -0,0 +1,58 @@
+#ifndef PCD_WRITER_H
+#define PCD_WRITER_H
+
+#include "pcd_parser/pcd_parser.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pcd {
+
+// Streaming PCD writer: points are appended in column chunks and WIDTH /
+// POINTS are filled in on close(), so clouds larger than memory can be
+// converted or merged (e.g. fed from PCDReader). Columns are written as
+// given; unlike PCDParser::write() no rgb packing or unpacking is applied.
+//
+// Output goes to a temporary sibling file that replaces `filepath` on
+// close(); a writer destroyed without close() leaves the target untouched.
+class PCDWriter {
+public:
+  PCDWriter(const std::string &filepath, const PCDHeader &header,
+            const std::string &format = "binary");
+  ~PCDWriter();
+
+  PCDWriter(const PCDWriter &) = delete;
+  PCDWriter &operator=(const PCDWriter &) = delete;
+
+  // Append a chunk whose columns match the header's fields
+  void append(const PCDData &chunk);
+
+  // Finish the data section, patch the point count and publish the file
+  void close();
+
+  size_t pointsWritten() const { return points_; }
+
+private:
+  void checkChunk(const PCDData &chunk) const;
+  void writeCompressedData();
+  void discard();
+
+  std::string filepath_;
+  std::string tmpPath_;
+  PCDHeader header_;
+  std::string format_;
+  std::ofstream out_;
+  std::streamoff widthSlot_ = 0;
+  std::streamoff pointsSlot_ = 0;
+  size_t points_ = 0;
+  bool closed_ = false;
+
+  // binary_compressed stores each field contiguously, so columns are
+  // spooled to one temporary file per field until close()
+  std::vector<std::string> columnPaths_;
+  std::vector<std::ofstream> columnFiles_;
+};
+
+} // namespace pcd
+
+#endif // PCD_WRITER_H
@@ -0,0 +1,76 @@
+#ifndef PCD_SELECTION_H
+#define PCD_SELECTION_H
+
+#include "pcd_parser/octree.h"
+#include <cstdint>
+#include <vector>
+
+namespace pcd {
+
+// Camera and viewport a selection polygon was drawn against
+struct SelectionView {
+  // World to clip space, column-major (THREE.Matrix4.elements order)
+  float matrix[16];
+  // Viewport rectangle in the polygon's pixel coordinates (y down)
+  float left = 0;
+  float top = 0;
+  float width = 0;
+  float height = 0;
+};
+
+struct ScreenPoint {
+  float x;
+  float y;
+};
+
+// Selects the points whose screen projection falls inside a polygon (even-odd
+// rule). The polygon is rasterized once into a coarse mask of cells that are
+// wholly inside, wholly outside or crossed by an edge; only points landing in
+// edge cells get the exact test. Points behind the camera or beyond the far
+// plane are never selected.
+//
+// Results are packed bitsets: point i is selected when bit (i & 7) of byte
+// (i >> 3) is set.
+class PolygonSelector {
+public:
+  // Mask cells per axis at most
+  static constexpr int kMaxMaskSize = 1024;
+
+  PolygonSelector(const SelectionView &view, std::vector<ScreenPoint> polygon);
+
+  // Test n points given as interleaved x, y, z
+  std::vector<uint8_t> select(const float *xyz, size_t n,
+                              unsigned threads = 0) const;
+  // Test the points of an octree, culling and accepting whole nodes by their
+  // projected bounds. The bitset covers `numPoints` original indices.
+  std::vector<uint8_t> select(const Octree &tree, size_t numPoints,
+                              unsigned threads = 0) const;
+
+  // Exact even-odd test of a screen position
+  bool contains(float x, float y) const;
+
+private:
+  enum Cell : uint8_t { Outside = 0, Inside = 1, Edge = 2 };
+
+  void rasterize();
+  // Project `count` points and set hits[i] for those inside the polygon
+  void testPoints(const float *xyz, size_t count, uint8_t *hits) const;
+  // 0 = no point of the node can be selected, 1 = all are, 2 = test them
+  int classifyNode(const OctreeNode &node) const;
+  // Cells of [x0, x1] x [y0, y1] (inclusive) not in the given state
+  uint32_t countOther(const std::vector<uint32_t> &table, int x0, int y0,
+                      int x1, int y1) const;
+
+  SelectionView view_;
+  std::vector<ScreenPoint> polygon_;
+  float originX_ = 0, originY_ = 0; // Screen position of the mask's corner
+  float cellSize_ = 1;
+  int cols_ = 0, rows_ = 0;
+  std::vector<uint8_t> cells_;
+  // Summed-area tables of cells that are not Inside / not Outside
+  std::vector<uint32_t> notInside_, notOutside_;
+};
+
+} // namespace pcd
+
+#endif // PCD_SELECTION_H
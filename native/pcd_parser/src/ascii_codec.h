@@ -0,0 +1,276 @@
+#ifndef PCD_ASCII_CODEC_H
+#define PCD_ASCII_CODEC_H
+
+// Non-allocating tokenizer, number parsing and formatting for DATA ascii
+// sections
+
+#include "pcd_parser/pcd_parser.h"
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace pcd {
+namespace detail {
+
+inline bool isAsciiSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Integers are parsed as int64 and narrowed like the std::stoi/stoul casts
+// they replace ("-1" in a U4 field becomes 4294967295, "1.5" parses as 1).
+// Unparseable tokens yield 0.
+template <typename T> T parseInteger(const char *begin, const char *end) {
+  if (begin < end && *begin == '+')
+    ++begin;
+  int64_t value = 0;
+  auto result = std::from_chars(begin, end, value);
+  if (result.ec != std::errc()) {
+    return T{};
+  }
+  return static_cast<T>(value);
+}
+
+// Floating-point tokens use from_chars where the standard library provides
+// it, otherwise strtod on a NUL-terminated copy. Unparseable tokens yield 0.
+template <typename T> T parseFloat(const char *begin, const char *end) {
+  if (begin < end && *begin == '+')
+    ++begin;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  T value{};
+  auto result = std::from_chars(begin, end, value);
+  if (result.ec != std::errc() && result.ec != std::errc::result_out_of_range) {
+    return T{};
+  }
+  return value;
+#else
+  char buffer[64];
+  size_t len = static_cast<size_t>(end - begin);
+  if (len == 0 || len >= sizeof(buffer)) {
+    return T{};
+  }
+  std::memcpy(buffer, begin, len);
+  buffer[len] = '\0';
+  char *parsedEnd = nullptr;
+  double value = std::strtod(buffer, &parsedEnd);
+  if (parsedEnd == buffer) {
+    return T{};
+  }
+  return static_cast<T>(value);
+#endif
+}
+
+// Column sink for one field: the storage kind is resolved once per field so
+// the per-token path is a single switch
+class AsciiColumn {
+public:
+  explicit AsciiColumn(const FieldInfo &field) : field_(field) {}
+
+  void bind(FieldData &storage) {
+    kind_ = Kind::Skip;
+    target_ = nullptr;
+    if (!field_.isSupported())
+      return;
+    std::visit(
+        [this](auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          kind_ = kindOf<T>();
+          target_ = &vec;
+        },
+        storage);
+  }
+
+  int count() const { return field_.count > 0 ? field_.count : 1; }
+
+  void push(const char *begin, const char *end) {
+    switch (kind_) {
+    case Kind::I8:
+      pushAs<int8_t>(parseInteger<int8_t>(begin, end));
+      break;
+    case Kind::U8:
+      pushAs<uint8_t>(parseInteger<uint8_t>(begin, end));
+      break;
+    case Kind::I16:
+      pushAs<int16_t>(parseInteger<int16_t>(begin, end));
+      break;
+    case Kind::U16:
+      pushAs<uint16_t>(parseInteger<uint16_t>(begin, end));
+      break;
+    case Kind::I32:
+      pushAs<int32_t>(parseInteger<int32_t>(begin, end));
+      break;
+    case Kind::U32:
+      pushAs<uint32_t>(parseInteger<uint32_t>(begin, end));
+      break;
+    case Kind::F32:
+      pushAs<float>(parseFloat<float>(begin, end));
+      break;
+    case Kind::F64:
+      pushAs<double>(parseFloat<double>(begin, end));
+      break;
+    case Kind::Skip:
+      break;
+    }
+  }
+
+  // Default value for a field missing from a short line
+  void pushDefault() {
+    static const char empty = '\0';
+    push(&empty, &empty);
+  }
+
+private:
+  enum class Kind { Skip, I8, U8, I16, U16, I32, U32, F32, F64 };
+
+  template <typename T> static Kind kindOf() {
+    if constexpr (std::is_same_v<T, int8_t>)
+      return Kind::I8;
+    else if constexpr (std::is_same_v<T, uint8_t>)
+      return Kind::U8;
+    else if constexpr (std::is_same_v<T, int16_t>)
+      return Kind::I16;
+    else if constexpr (std::is_same_v<T, uint16_t>)
+      return Kind::U16;
+    else if constexpr (std::is_same_v<T, int32_t>)
+      return Kind::I32;
+    else if constexpr (std::is_same_v<T, uint32_t>)
+      return Kind::U32;
+    else if constexpr (std::is_same_v<T, float>)
+      return Kind::F32;
+    else
+      return Kind::F64;
+  }
+
+  template <typename T> void pushAs(T value) {
+    static_cast<std::vector<T> *>(target_)->push_back(value);
+  }
+
+  const FieldInfo &field_;
+  Kind kind_ = Kind::Skip;
+  void *target_ = nullptr;
+};
+
+// Parse the ascii records in [begin, end) into `columns` (one per field).
+// Lines without tokens are skipped; short lines are padded with defaults so
+// every column stays the same length. Only the first value of a COUNT > 1
+// field is kept, matching the binary decoders. Fields with decode[f] false
+// are tokenized but not stored (nullptr decodes every field).
+inline void parseAsciiRange(const char *begin, const char *end,
+                            const std::vector<FieldInfo> &fields,
+                            std::vector<FieldData> &columns,
+                            const std::vector<bool> *decode = nullptr) {
+  std::vector<AsciiColumn> sinks;
+  sinks.reserve(fields.size());
+  for (size_t f = 0; f < fields.size(); f++) {
+    sinks.emplace_back(fields[f]);
+    if (!decode || (*decode)[f])
+      sinks.back().bind(columns[f]);
+  }
+
+  const char *p = begin;
+  while (p < end) {
+    const char *lineEnd =
+        static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (!lineEnd)
+      lineEnd = end;
+
+    const char *cursor = p;
+    auto nextToken = [&cursor, lineEnd](const char *&tokEnd) -> const char * {
+      while (cursor < lineEnd && isAsciiSpace(*cursor))
+        ++cursor;
+      if (cursor == lineEnd)
+        return nullptr;
+      const char *tokBegin = cursor;
+      while (cursor < lineEnd && !isAsciiSpace(*cursor))
+        ++cursor;
+      tokEnd = cursor;
+      return tokBegin;
+    };
+
+    const char *tokEnd = nullptr;
+    const char *tok = nextToken(tokEnd);
+    if (tok) {
+      for (auto &sink : sinks) {
+        if (tok) {
+          sink.push(tok, tokEnd);
+          for (int c = 0; c < sink.count() && tok; c++)
+            tok = nextToken(tokEnd);
+        } else {
+          sink.pushDefault();
+        }
+      }
+    }
+
+    p = lineEnd + 1;
+  }
+}
+
+// Upper bound on the characters one formatted value needs
+constexpr size_t kMaxFormattedValue = 32;
+
+// Format one value of a column, returning the end of the written text.
+// Floats use the shortest representation that parses back to the same value;
+// integers are printed through int64 like the stream writer they replace.
+template <typename T>
+char *formatValue(const void *column, size_t index, char *out) {
+  T value = static_cast<const T *>(column)[index];
+  if constexpr (std::is_floating_point_v<T>) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    return std::to_chars(out, out + kMaxFormattedValue, value).ptr;
+#else
+    int len = std::snprintf(out, kMaxFormattedValue,
+                            sizeof(T) == 4 ? "%.9g" : "%.17g",
+                            static_cast<double>(value));
+    return out + len;
+#endif
+  } else {
+    return std::to_chars(out, out + kMaxFormattedValue,
+                         static_cast<int64_t>(value))
+        .ptr;
+  }
+}
+
+using FormatFn = char *(*)(const void *column, size_t index, char *out);
+
+// Append the ascii records for points [first, last) to `out`. Values missing
+// from short columns are left empty, as the stream writer did.
+inline void formatAsciiRange(const std::vector<FieldData> &columns,
+                             size_t first, size_t last, std::string &out) {
+  struct Column {
+    FormatFn fn;
+    const void *data;
+    size_t size;
+  };
+  std::vector<Column> formatters;
+  formatters.reserve(columns.size());
+  for (const auto &column : columns) {
+    std::visit(
+        [&formatters](const auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          formatters.push_back({formatValue<T>, vec.data(), vec.size()});
+        },
+        column);
+  }
+
+  size_t rowBound = formatters.size() * (kMaxFormattedValue + 1) + 1;
+  size_t start = out.size();
+  out.resize(start + (last - first) * rowBound);
+  char *p = out.data() + start;
+  for (size_t pt = first; pt < last; pt++) {
+    for (size_t f = 0; f < formatters.size(); f++) {
+      if (f > 0)
+        *p++ = ' ';
+      if (pt < formatters[f].size)
+        p = formatters[f].fn(formatters[f].data, pt, p);
+    }
+    *p++ = '\n';
+  }
+  out.resize(static_cast<size_t>(p - out.data()));
+}
+
+} // namespace detail
+} // namespace pcd
+
+#endif // PCD_ASCII_CODEC_H
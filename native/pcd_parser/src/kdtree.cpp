@@ -0,0 +1,381 @@
+#include "pcd_parser/kdtree.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace pcd {
+
+// Points per parallel task when gathering positions
+static constexpr size_t kBuildChunk = 1 << 16;
+// Points per parallel task when smoothing labels
+static constexpr size_t kSmoothChunk = 1 << 12;
+// Deeper than any tree over 2^32 points with leaves of two or more
+static constexpr int kMaxDepth = 64;
+
+namespace {
+
+struct KdPoint {
+  float p[3];
+  uint32_t index;
+};
+
+// Node waiting to be split, with its place in the depth-first layout
+struct PendingNode {
+  uint32_t node;
+  uint32_t first;
+  uint32_t count;
+};
+
+// Nodes in a subtree over `count` points. Median splits make this depend on
+// the count alone, so every node's index is known before its parent is
+// split and the levels below it can be built in parallel.
+class SubtreeSizes {
+public:
+  SubtreeSizes(uint32_t count, uint32_t leafSize) : leafSize_(leafSize) {
+    fill(count);
+  }
+  uint32_t operator()(uint32_t count) const { return sizes_.at(count); }
+
+private:
+  uint32_t fill(uint32_t count) {
+    auto found = sizes_.find(count);
+    if (found != sizes_.end())
+      return found->second;
+    uint32_t size = 1;
+    if (count > leafSize_)
+      size += fill(count / 2) + fill(count - count / 2);
+    sizes_[count] = size;
+    return size;
+  }
+
+  uint32_t leafSize_;
+  std::unordered_map<uint32_t, uint32_t> sizes_;
+};
+
+float distanceSq(const float *a, const float *b) {
+  float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+  return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+KdTree KdTree::build(const float *x, const float *y, const float *z, size_t n,
+                     const KdTreeOptions &options) {
+  if (n > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Kd-tree is limited to 2^32 points");
+  }
+  unsigned threads = detail::resolveThreadCount(options.threads);
+  size_t tasks = (n + kBuildChunk - 1) / kBuildChunk;
+  auto finitePoint = [&](size_t i) {
+    return std::isfinite(x[i]) && std::isfinite(y[i]) && std::isfinite(z[i]);
+  };
+
+  std::vector<size_t> offsets(tasks + 1, 0);
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t last = std::min(n, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++)
+      offsets[t + 1] += finitePoint(i);
+  });
+  for (size_t t = 0; t < tasks; t++)
+    offsets[t + 1] += offsets[t];
+
+  KdTree tree;
+  tree.order_.resize(offsets[tasks]);
+  tree.positions_.resize(offsets[tasks] * 3);
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t k = offsets[t];
+    size_t last = std::min(n, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++) {
+      if (!finitePoint(i))
+        continue;
+      tree.order_[k] = static_cast<uint32_t>(i);
+      tree.positions_[k * 3] = x[i];
+      tree.positions_[k * 3 + 1] = y[i];
+      tree.positions_[k * 3 + 2] = z[i];
+      k++;
+    }
+  });
+  tree.split(options);
+  return tree;
+}
+
+KdTree KdTree::build(const Octree &octree, const KdTreeOptions &options) {
+  KdTree tree;
+  tree.order_ = octree.order();
+  tree.positions_ = octree.positions();
+  tree.split(options);
+  return tree;
+}
+
+void KdTree::split(const KdTreeOptions &options) {
+  size_t n = order_.size();
+  if (n == 0)
+    return;
+  unsigned threads = detail::resolveThreadCount(options.threads);
+  uint32_t leafSize = std::max<uint32_t>(options.leafSize, 2);
+  size_t tasks = (n + kBuildChunk - 1) / kBuildChunk;
+
+  // Partition whole points rather than indices into the position array
+  std::vector<KdPoint> points(n);
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t last = std::min(n, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++) {
+      std::copy_n(&positions_[i * 3], 3, points[i].p);
+      points[i].index = order_[i];
+    }
+  });
+
+  SubtreeSizes sizes(static_cast<uint32_t>(n), leafSize);
+  nodes_.assign(sizes(static_cast<uint32_t>(n)), KdNode{});
+
+  // Level by level: nodes of one level cover disjoint ranges
+  std::vector<PendingNode> level{{0, 0, static_cast<uint32_t>(n)}};
+  while (!level.empty()) {
+    detail::parallelFor(level.size(), threads, [&](size_t t) {
+      const PendingNode &pending = level[t];
+      KdNode &node = nodes_[pending.node];
+      node.first = pending.first;
+      node.count = pending.count;
+      if (pending.count <= leafSize)
+        return;
+
+      auto begin = points.begin() + pending.first;
+      auto end = begin + pending.count;
+      float lo[3] = {INFINITY, INFINITY, INFINITY};
+      float hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+      for (auto it = begin; it != end; ++it) {
+        for (int a = 0; a < 3; a++) {
+          lo[a] = std::min(lo[a], it->p[a]);
+          hi[a] = std::max(hi[a], it->p[a]);
+        }
+      }
+      int axis = 0;
+      for (int a = 1; a < 3; a++) {
+        if (hi[a] - lo[a] > hi[axis] - lo[axis])
+          axis = a;
+      }
+
+      uint32_t half = pending.count / 2;
+      std::nth_element(begin, begin + half, end,
+                       [axis](const KdPoint &a, const KdPoint &b) {
+                         return a.p[axis] < b.p[axis];
+                       });
+      node.split = begin[half].p[axis];
+      node.axis = static_cast<uint8_t>(axis);
+      node.right = pending.node + 1 + sizes(half);
+    });
+
+    std::vector<PendingNode> nextLevel;
+    nextLevel.reserve(level.size() * 2);
+    for (const PendingNode &pending : level) {
+      const KdNode &node = nodes_[pending.node];
+      if (node.right == 0)
+        continue;
+      uint32_t half = pending.count / 2;
+      nextLevel.push_back({pending.node + 1, pending.first, half});
+      nextLevel.push_back(
+          {node.right, pending.first + half, pending.count - half});
+    }
+    level = std::move(nextLevel);
+  }
+
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t last = std::min(n, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++) {
+      std::copy_n(points[i].p, 3, &positions_[i * 3]);
+      order_[i] = points[i].index;
+    }
+  });
+}
+
+size_t KdTree::bytes() const {
+  return nodes_.size() * sizeof(KdNode) + order_.size() * sizeof(uint32_t) +
+         positions_.size() * sizeof(float);
+}
+
+void KdTree::nearest(const float point[3], size_t k, float maxDistanceSq,
+                     std::vector<Neighbour> &heap) const {
+  heap.clear();
+  if (nodes_.empty() || k == 0)
+    return;
+  auto bound = [&] {
+    return heap.size() < k ? maxDistanceSq : heap.front().first;
+  };
+
+  // Far children still to visit, with a lower bound on their distance
+  struct Pending {
+    uint32_t node;
+    float distanceSq;
+  };
+  Pending stack[kMaxDepth];
+  int top = 0;
+  stack[top++] = {0, 0.0f};
+  while (top > 0) {
+    Pending pending = stack[--top];
+    if (pending.distanceSq > bound())
+      continue;
+    uint32_t id = pending.node;
+    // Descend to the leaf on the query's side, deferring the far sides
+    while (nodes_[id].right != 0) {
+      const KdNode &node = nodes_[id];
+      float diff = point[node.axis] - node.split;
+      uint32_t nearChild = diff < 0 ? id + 1 : node.right;
+      uint32_t farChild = diff < 0 ? node.right : id + 1;
+      float farDistance = std::max(pending.distanceSq, diff * diff);
+      if (farDistance <= bound())
+        stack[top++] = {farChild, farDistance};
+      id = nearChild;
+    }
+
+    const KdNode &leaf = nodes_[id];
+    for (uint32_t p = leaf.first; p < leaf.first + leaf.count; p++) {
+      float d = distanceSq(point, &positions_[static_cast<size_t>(p) * 3]);
+      if (heap.size() < k) {
+        if (d <= maxDistanceSq) {
+          heap.push_back({d, p});
+          std::push_heap(heap.begin(), heap.end());
+        }
+      } else if (d < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = {d, p};
+        std::push_heap(heap.begin(), heap.end());
+      }
+    }
+  }
+}
+
+void KdTree::knn(const float point[3], size_t k, std::vector<uint32_t> &out,
+                 std::vector<float> *distancesSq) const {
+  std::vector<Neighbour> heap;
+  nearest(point, k, INFINITY, heap);
+  std::sort_heap(heap.begin(), heap.end());
+  out.clear();
+  if (distancesSq)
+    distancesSq->clear();
+  for (const Neighbour &neighbour : heap) {
+    out.push_back(order_[neighbour.second]);
+    if (distancesSq)
+      distancesSq->push_back(neighbour.first);
+  }
+}
+
+void KdTree::radius(const float center[3], float radius,
+                    std::vector<uint32_t> &out) const {
+  if (nodes_.empty() || !(radius >= 0))
+    return;
+  float radiusSq = radius * radius;
+  uint32_t stack[kMaxDepth];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    uint32_t id = stack[--top];
+    const KdNode &node = nodes_[id];
+    if (node.right == 0) {
+      for (uint32_t p = node.first; p < node.first + node.count; p++) {
+        if (distanceSq(center, &positions_[static_cast<size_t>(p) * 3]) <=
+            radiusSq)
+          out.push_back(order_[p]);
+      }
+      continue;
+    }
+    // Right pushed first so the left side comes out first, in tree order
+    float diff = center[node.axis] - node.split;
+    if (diff >= -radius)
+      stack[top++] = node.right;
+    if (diff <= radius)
+      stack[top++] = id + 1;
+  }
+}
+
+std::vector<uint32_t> smoothLabels(const KdTree &tree,
+                                   const std::vector<uint32_t> &labels,
+                                   const std::vector<uint8_t> &mask,
+                                   const SmoothOptions &options) {
+  if (!mask.empty() && mask.size() < (labels.size() + 7) / 8) {
+    throw std::runtime_error("Selection mask is shorter than the labels");
+  }
+  const auto &order = tree.order();
+  const auto &positions = tree.positions();
+  size_t n = tree.numPoints();
+  unsigned threads = detail::resolveThreadCount(options.threads);
+
+  // Labels in tree order, and the tree positions to update
+  std::vector<uint32_t> current(n);
+  std::vector<uint32_t> targets;
+  for (size_t s = 0; s < n; s++) {
+    uint32_t index = order[s];
+    if (index >= labels.size()) {
+      throw std::runtime_error("Label count does not match the cloud");
+    }
+    current[s] = labels[index];
+    if (mask.empty() || (mask[index >> 3] >> (index & 7) & 1))
+      targets.push_back(static_cast<uint32_t>(s));
+  }
+
+  size_t k = std::max<uint32_t>(options.k, 1);
+  float maxDistanceSq =
+      options.radius > 0 ? options.radius * options.radius : INFINITY;
+  size_t tasks = (targets.size() + kSmoothChunk - 1) / kSmoothChunk;
+  std::vector<uint32_t> next = current;
+  for (uint32_t iteration = 0; iteration < options.iterations; iteration++) {
+    std::atomic<bool> changed{false};
+    detail::parallelFor(tasks, threads, [&](size_t t) {
+      std::vector<KdTree::Neighbour> heap;
+      // (label, votes)
+      std::vector<std::pair<uint32_t, uint32_t>> votes;
+      bool taskChanged = false;
+      size_t last = std::min(targets.size(), (t + 1) * kSmoothChunk);
+      for (size_t i = t * kSmoothChunk; i < last; i++) {
+        uint32_t s = targets[i];
+        tree.nearest(&positions[static_cast<size_t>(s) * 3], k, maxDistanceSq,
+                     heap);
+        votes.clear();
+        for (const auto &neighbour : heap) {
+          uint32_t label = current[neighbour.second];
+          if (options.ignoreUnlabeled && label == 0)
+            continue;
+          auto vote = std::find_if(votes.begin(), votes.end(),
+                                   [label](const auto &v) {
+                                     return v.first == label;
+                                   });
+          if (vote != votes.end())
+            vote->second++;
+          else
+            votes.push_back({label, 1});
+        }
+
+        uint32_t own = current[s];
+        uint32_t best = own, bestVotes = 0;
+        for (const auto &vote : votes) {
+          if (vote.first == own)
+            bestVotes = vote.second;
+        }
+        for (const auto &vote : votes) {
+          if (vote.second > bestVotes ||
+              (vote.second == bestVotes && best != own && vote.first < best)) {
+            best = vote.first;
+            bestVotes = vote.second;
+          }
+        }
+        next[s] = best;
+        taskChanged |= best != own;
+      }
+      if (taskChanged)
+        changed = true;
+    });
+    if (!changed)
+      break;
+    current = next;
+  }
+
+  std::vector<uint32_t> result = labels;
+  for (uint32_t s : targets)
+    result[order[s]] = current[s];
+  return result;
+}
+
+} // namespace pcd
@@ -0,0 +1,212 @@
+#include "pcd_parser/lod.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace pcd {
+
+static constexpr uint32_t kNoParent = std::numeric_limits<uint32_t>::max();
+
+namespace {
+
+// Octree node waiting to become a LOD node at the next level
+struct PendingNode {
+  uint32_t octree;
+  uint32_t parent; // LOD node index, kNoParent for the root
+};
+
+// Clip-space corners of a node: whether the node lies wholly outside one
+// frustum plane, and the smallest w of its corners
+bool frustumTest(const LodNode &node, const float *m, float &minW) {
+  int outside[6] = {0, 0, 0, 0, 0, 0};
+  minW = INFINITY;
+  for (int corner = 0; corner < 8; corner++) {
+    float x = corner & 1 ? node.max[0] : node.min[0];
+    float y = corner & 2 ? node.max[1] : node.min[1];
+    float z = corner & 4 ? node.max[2] : node.min[2];
+    float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+    outside[0] += cx < -cw;
+    outside[1] += cx > cw;
+    outside[2] += cy < -cw;
+    outside[3] += cy > cw;
+    outside[4] += cz < -cw;
+    outside[5] += cz > cw;
+    minW = std::min(minW, cw);
+  }
+  for (int plane = 0; plane < 6; plane++) {
+    if (outside[plane] == 8)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+LodHierarchy LodHierarchy::build(const Octree &tree,
+                                 const LodOptions &options) {
+  LodHierarchy lod;
+  const auto &octreeNodes = tree.nodes();
+  if (octreeNodes.empty())
+    return lod;
+
+  unsigned threads = detail::resolveThreadCount(options.threads);
+  uint64_t budget = std::max<uint32_t>(options.nodePoints, 1);
+  std::vector<uint8_t> taken(tree.numPoints(), 0);
+  // Sorted-point positions of each LOD node's points
+  std::vector<std::vector<uint32_t>> members;
+
+  // Level by level: nodes of one level cover disjoint ranges, so they
+  // sample in parallel
+  std::vector<PendingNode> level{{0, kNoParent}};
+  while (!level.empty()) {
+    std::vector<std::vector<uint32_t>> picked(level.size());
+    std::vector<uint8_t> complete(level.size(), 0);
+    detail::parallelFor(level.size(), threads, [&](size_t t) {
+      const OctreeNode &node = octreeNodes[level[t].octree];
+      uint32_t end = node.first + node.count;
+      uint64_t remaining = 0;
+      for (uint32_t i = node.first; i < end; i++)
+        remaining += !taken[i];
+
+      auto &out = picked[t];
+      if (remaining <= budget || node.childCount == 0) {
+        // The subtree's last points: nothing is left for descendants
+        complete[t] = 1;
+        out.reserve(remaining);
+        for (uint32_t i = node.first; i < end; i++) {
+          if (!taken[i])
+            out.push_back(i);
+        }
+        return;
+      }
+
+      // Points are in Morton order, so an even stride over the points not
+      // yet taken spreads the sample across the node
+      out.reserve(budget);
+      uint64_t seen = 0, picks = 0, next = 0;
+      for (uint32_t i = node.first; i < end && picks < budget; i++) {
+        if (taken[i])
+          continue;
+        if (seen++ == next) {
+          taken[i] = 1;
+          out.push_back(i);
+          next = ++picks * remaining / budget;
+        }
+      }
+    });
+
+    std::vector<PendingNode> nextLevel;
+    for (size_t t = 0; t < level.size(); t++) {
+      if (picked[t].empty())
+        continue; // Subtree exhausted by its ancestors
+      const OctreeNode &source = octreeNodes[level[t].octree];
+      uint32_t id = static_cast<uint32_t>(lod.nodes_.size());
+
+      LodNode node{};
+      float extent = 0;
+      for (int a = 0; a < 3; a++) {
+        node.min[a] = source.min[a];
+        node.max[a] = source.max[a];
+        extent = std::max(extent, source.max[a] - source.min[a]);
+      }
+      node.count = static_cast<uint32_t>(picked[t].size());
+      node.level = source.level;
+      // Sampled points spread over a mostly two-dimensional surface
+      node.spacing =
+          complete[t] ? 0.0f : extent / std::sqrt(static_cast<float>(node.count));
+      if (level[t].parent != kNoParent) {
+        LodNode &parent = lod.nodes_[level[t].parent];
+        if (parent.childCount == 0)
+          parent.firstChild = id;
+        parent.childCount++;
+      }
+      lod.nodes_.push_back(node);
+      members.push_back(std::move(picked[t]));
+
+      if (!complete[t]) {
+        for (uint32_t c = 0; c < source.childCount; c++)
+          nextLevel.push_back({source.firstChild + c, id});
+      }
+    }
+    level = std::move(nextLevel);
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < lod.nodes_.size(); i++) {
+    lod.nodes_[i].first = static_cast<uint32_t>(total);
+    total += members[i].size();
+  }
+  lod.indices_.resize(total);
+  lod.positions_.resize(total * 3);
+  const auto &order = tree.order();
+  const auto &positions = tree.positions();
+  detail::parallelFor(lod.nodes_.size(), threads, [&](size_t i) {
+    size_t at = lod.nodes_[i].first;
+    for (uint32_t sorted : members[i]) {
+      lod.indices_[at] = order[sorted];
+      std::copy_n(&positions[static_cast<size_t>(sorted) * 3], 3,
+                  &lod.positions_[at * 3]);
+      at++;
+    }
+  });
+  return lod;
+}
+
+size_t LodHierarchy::bytes() const {
+  return nodes_.size() * sizeof(LodNode) + indices_.size() * sizeof(uint32_t) +
+         positions_.size() * sizeof(float);
+}
+
+std::vector<uint32_t> LodHierarchy::select(const float matrix[16],
+                                           float viewportHeight,
+                                           const LodQuery &query) const {
+  std::vector<uint32_t> selected;
+  if (nodes_.empty())
+    return selected;
+
+  // Pixels per world unit at clip w = 1: the length of the matrix's y row
+  // is the projection's y scale whatever the camera's rotation
+  float pixelScale = std::sqrt(matrix[1] * matrix[1] + matrix[5] * matrix[5] +
+                               matrix[9] * matrix[9]) *
+                     viewportHeight * 0.5f;
+  auto projectedSpacing = [&](const LodNode &node, float minW) {
+    // Nodes reaching behind the camera plane are always refined
+    if (!(minW > 0))
+      return INFINITY;
+    return node.spacing * pixelScale / minW;
+  };
+
+  // Largest projected spacing first
+  using Candidate = std::pair<float, uint32_t>;
+  std::priority_queue<Candidate> queue;
+  float minW;
+  if (frustumTest(nodes_[0], matrix, minW))
+    queue.push({projectedSpacing(nodes_[0], minW), 0});
+
+  size_t points = 0;
+  while (!queue.empty()) {
+    auto [error, id] = queue.top();
+    queue.pop();
+    const LodNode &node = nodes_[id];
+    if (points + node.count > query.pointBudget)
+      break;
+    selected.push_back(id);
+    points += node.count;
+    if (!(error > query.errorPixels))
+      continue;
+    for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount;
+         c++) {
+      if (frustumTest(nodes_[c], matrix, minW))
+        queue.push({projectedSpacing(nodes_[c], minW), c});
+    }
+  }
+  return selected;
+}
+
+} // namespace pcd
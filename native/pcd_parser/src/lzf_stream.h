@@ -0,0 +1,88 @@
+#ifndef PCD_LZF_STREAM_H
+#define PCD_LZF_STREAM_H
+
+// Streaming decoder for LZF blocks (the DATA binary_compressed payload).
+// LZF back-references reach at most 8 KiB behind the output cursor, so the
+// output can be decoded through a small sliding window and handed to a sink
+// in pieces instead of being materialized as one full-size buffer.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace pcd {
+namespace detail {
+
+// Decode `inLen` bytes of LZF data, calling sink(const uint8_t *, size_t)
+// with the output in order. Returns the number of bytes produced.
+template <typename Sink>
+size_t lzfDecompressStream(const uint8_t *in, size_t inLen, Sink &&sink) {
+  constexpr size_t kHistory = 8192;     // Maximum LZF back-reference distance
+  constexpr size_t kMaxOp = 264;        // Longest single literal run or match
+  constexpr size_t kWindow = 256 * 1024;
+
+  std::vector<uint8_t> window(kWindow + kHistory);
+  size_t wpos = 0;     // Write cursor within the window
+  size_t produced = 0; // Total bytes decoded so far
+
+  const uint8_t *ip = in;
+  const uint8_t *inEnd = in + inLen;
+
+  auto fail = []() {
+    throw std::runtime_error("LZF decompression failed");
+  };
+
+  while (ip < inEnd) {
+    // Hand everything but the back-reference history to the sink
+    if (wpos + kMaxOp > window.size()) {
+      size_t flush = wpos - kHistory;
+      sink(window.data(), flush);
+      std::memmove(window.data(), window.data() + flush, kHistory);
+      wpos = kHistory;
+    }
+
+    unsigned int ctrl = *ip++;
+    if (ctrl < 32) {
+      // Literal run of ctrl + 1 bytes
+      size_t len = ctrl + 1;
+      if (static_cast<size_t>(inEnd - ip) < len)
+        fail();
+      std::memcpy(window.data() + wpos, ip, len);
+      ip += len;
+      wpos += len;
+      produced += len;
+    } else {
+      // Back-reference of (ctrl >> 5) + 2 bytes, extended by one length byte
+      size_t len = ctrl >> 5;
+      if (len == 7) {
+        if (ip >= inEnd)
+          fail();
+        len += *ip++;
+      }
+      if (ip >= inEnd)
+        fail();
+      size_t distance = (static_cast<size_t>(ctrl & 0x1f) << 8) + *ip++ + 1;
+      len += 2;
+      if (distance > produced || distance > wpos)
+        fail();
+
+      // Byte-wise: overlapping references repeat the preceding bytes
+      uint8_t *out = window.data() + wpos;
+      const uint8_t *ref = out - distance;
+      for (size_t i = 0; i < len; i++)
+        out[i] = ref[i];
+      wpos += len;
+      produced += len;
+    }
+  }
+
+  sink(window.data(), wpos);
+  return produced;
+}
+
+} // namespace detail
+} // namespace pcd
+
+#endif // PCD_LZF_STREAM_H
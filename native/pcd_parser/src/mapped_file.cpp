@@ -0,0 +1,117 @@
+#include "pcd_parser/mapped_file.h"
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pcd {
+
+#ifndef _WIN32
+
+MappedFile::MappedFile(const std::string &filepath, Mode mode) {
+  int flags = mode == Mode::ReadWrite ? O_RDWR : O_RDONLY;
+  int fd = ::open(filepath.c_str(), flags);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open file: " + filepath);
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Failed to stat file: " + filepath);
+  }
+
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ == 0) {
+    // mmap rejects zero-length mappings; an empty view is still valid
+    ::close(fd);
+    return;
+  }
+
+  int prot = mode == Mode::ReadWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+  void *addr = ::mmap(nullptr, size_, prot, MAP_SHARED, fd, 0);
+  // The mapping keeps its own reference to the file
+  ::close(fd);
+
+  if (addr == MAP_FAILED) {
+    size_ = 0;
+    throw std::runtime_error("Failed to map file: " + filepath);
+  }
+
+  data_ = static_cast<uint8_t *>(addr);
+  // Parsers walk the data section front to back
+  ::madvise(addr, size_, MADV_SEQUENTIAL);
+}
+
+void MappedFile::release() {
+  if (data_) {
+    ::munmap(data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  heapBacked_ = false;
+}
+
+#else
+
+// No mmap: read the whole file into memory so callers can use the same view
+MappedFile::MappedFile(const std::string &filepath, Mode mode) {
+  if (mode == Mode::ReadWrite) {
+    throw std::runtime_error("Writable file mappings are not supported");
+  }
+
+  std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + filepath);
+  }
+
+  size_ = static_cast<size_t>(file.tellg());
+  file.seekg(0);
+  if (size_ == 0)
+    return;
+
+  data_ = new uint8_t[size_];
+  heapBacked_ = true;
+  if (!file.read(reinterpret_cast<char *>(data_), size_)) {
+    release();
+    throw std::runtime_error("Failed to read file: " + filepath);
+  }
+}
+
+void MappedFile::release() {
+  delete[] data_;
+  data_ = nullptr;
+  size_ = 0;
+  heapBacked_ = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(other.data_), size_(other.size_), heapBacked_(other.heapBacked_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.heapBacked_ = false;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    release();
+    data_ = other.data_;
+    size_ = other.size_;
+    heapBacked_ = other.heapBacked_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.heapBacked_ = false;
+  }
+  return *this;
+}
+
+} // namespace pcd
@@ -0,0 +1,432 @@
+#include "pcd_parser/octree.h"
+#include "parallel.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace pcd {
+
+// Points per parallel task when computing bounds and codes
+static constexpr size_t kBuildChunk = 1 << 16;
+
+static constexpr char kOctreeMagic[] = "PCDOCT01";
+static constexpr size_t kOctreeMagicSize = sizeof(kOctreeMagic) - 1;
+
+namespace {
+
+struct MortonKey {
+  uint64_t code;
+  uint32_t index;
+
+  bool operator<(const MortonKey &other) const { return code < other.code; }
+};
+
+// Insert two zero bits between each of the low 21 bits of v
+uint64_t spreadBits(uint32_t v) {
+  uint64_t x = v & 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
+}
+
+// Chunks sorted in parallel, then merged pairwise in parallel rounds
+void parallelSort(std::vector<MortonKey> &keys, unsigned threads) {
+  size_t chunks = std::min<size_t>(threads, (keys.size() + kBuildChunk - 1) /
+                                                kBuildChunk);
+  if (chunks <= 1) {
+    std::sort(keys.begin(), keys.end());
+    return;
+  }
+  auto bound = [&](size_t c) {
+    return keys.begin() + static_cast<std::ptrdiff_t>(
+                              std::min(c, chunks) * keys.size() / chunks);
+  };
+  detail::parallelFor(chunks, threads,
+                      [&](size_t c) { std::sort(bound(c), bound(c + 1)); });
+  for (size_t width = 1; width < chunks; width *= 2) {
+    size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+    detail::parallelFor(pairs, threads, [&](size_t p) {
+      size_t lo = p * 2 * width;
+      size_t mid = lo + width;
+      if (mid < chunks)
+        std::inplace_merge(bound(lo), bound(mid), bound(lo + 2 * width));
+    });
+  }
+}
+
+bool boxesOverlap(const OctreeNode &node, const float min[3],
+                  const float max[3]) {
+  for (int a = 0; a < 3; a++) {
+    if (node.max[a] < min[a] || node.min[a] > max[a])
+      return false;
+  }
+  return true;
+}
+
+bool boxContains(const float min[3], const float max[3],
+                 const OctreeNode &node) {
+  for (int a = 0; a < 3; a++) {
+    if (node.min[a] < min[a] || node.max[a] > max[a])
+      return false;
+  }
+  return true;
+}
+
+// Squared distances from `p` to the nearest and farthest points of a node
+void boxDistances(const OctreeNode &node, const float p[3], float &nearSq,
+                  float &farSq) {
+  nearSq = 0;
+  farSq = 0;
+  for (int a = 0; a < 3; a++) {
+    float below = node.min[a] - p[a];
+    float above = p[a] - node.max[a];
+    float d = std::max({below, above, 0.0f});
+    nearSq += d * d;
+    float f = std::max(std::abs(below), std::abs(above));
+    farSq += f * f;
+  }
+}
+
+// Depth-first traversal: `classify` returns 0 to skip a node, 1 to take all
+// of its points, 2 to descend (or test each point of a leaf with `accept`)
+template <typename Classify, typename Accept>
+void traverse(const std::vector<OctreeNode> &nodes,
+              const std::vector<uint32_t> &order,
+              const std::vector<float> &positions, const Classify &classify,
+              const Accept &accept, std::vector<uint32_t> &out) {
+  if (nodes.empty())
+    return;
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const OctreeNode &node = nodes[stack.back()];
+    stack.pop_back();
+    int action = classify(node);
+    if (action == 0)
+      continue;
+    if (action == 1) {
+      out.insert(out.end(), order.begin() + node.first,
+                 order.begin() + node.first + node.count);
+    } else if (node.childCount == 0) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        if (accept(&positions[static_cast<size_t>(i) * 3]))
+          out.push_back(order[i]);
+      }
+    } else {
+      // Reverse so children are visited in Morton order
+      for (uint32_t c = node.childCount; c > 0; c--)
+        stack.push_back(node.firstChild + c - 1);
+    }
+  }
+}
+
+template <typename T> void writePod(std::ostream &stream, const T &value) {
+  stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void readPod(std::istream &stream, T &value) {
+  stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeVector(std::ostream &stream, const std::vector<T> &values) {
+  writePod(stream, static_cast<uint64_t>(values.size()));
+  stream.write(reinterpret_cast<const char *>(values.data()),
+               static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T>
+void readVector(std::istream &stream, std::vector<T> &values) {
+  uint64_t size = 0;
+  readPod(stream, size);
+  if (!stream || size > std::numeric_limits<uint32_t>::max() * uint64_t(3)) {
+    throw std::runtime_error("Malformed octree data");
+  }
+  values.resize(static_cast<size_t>(size));
+  stream.read(reinterpret_cast<char *>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+} // namespace
+
+Octree Octree::build(const float *x, const float *y, const float *z, size_t n,
+                     const OctreeOptions &options) {
+  if (n > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Octree is limited to 2^32 points");
+  }
+  unsigned threads = detail::resolveThreadCount(options.threads);
+  size_t tasks = (n + kBuildChunk - 1) / kBuildChunk;
+
+  // Bounding cube of the finite points
+  std::vector<std::array<float, 6>> partial(
+      tasks, {INFINITY, INFINITY, INFINITY, -INFINITY, -INFINITY, -INFINITY});
+  std::vector<size_t> finiteCounts(tasks, 0);
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    auto &b = partial[t];
+    size_t last = std::min(n, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++) {
+      if (!std::isfinite(x[i]) || !std::isfinite(y[i]) || !std::isfinite(z[i]))
+        continue;
+      b[0] = std::min(b[0], x[i]);
+      b[1] = std::min(b[1], y[i]);
+      b[2] = std::min(b[2], z[i]);
+      b[3] = std::max(b[3], x[i]);
+      b[4] = std::max(b[4], y[i]);
+      b[5] = std::max(b[5], z[i]);
+      finiteCounts[t]++;
+    }
+  });
+  float lo[3] = {INFINITY, INFINITY, INFINITY};
+  float extent = 0;
+  size_t finite = 0;
+  for (size_t t = 0; t < tasks; t++) {
+    for (int a = 0; a < 3; a++)
+      lo[a] = std::min(lo[a], partial[t][a]);
+    finite += finiteCounts[t];
+  }
+  for (size_t t = 0; t < tasks; t++) {
+    for (int a = 0; a < 3; a++)
+      extent = std::max(extent, partial[t][a + 3] - lo[a]);
+  }
+
+  Octree tree;
+  tree.leafSize_ = std::max<uint32_t>(options.leafSize, 1);
+  if (finite == 0) {
+    return tree;
+  }
+
+  // Morton codes of the finite points, keyed by original index
+  const double cells = double(1u << kMaxLevel);
+  double scale = extent > 0 ? cells / extent : 0;
+  auto quantize = [&](float v, int a) {
+    double q = (double(v) - lo[a]) * scale;
+    return static_cast<uint32_t>(std::min(q, cells - 1));
+  };
+  std::vector<size_t> offsets(tasks, 0);
+  for (size_t t = 1; t < tasks; t++)
+    offsets[t] = offsets[t - 1] + finiteCounts[t - 1];
+  std::vector<MortonKey> keys(finite);
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t k = offsets[t];
+    size_t last = std::min(n, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++) {
+      if (!std::isfinite(x[i]) || !std::isfinite(y[i]) || !std::isfinite(z[i]))
+        continue;
+      keys[k++] = {spreadBits(quantize(x[i], 0)) |
+                       spreadBits(quantize(y[i], 1)) << 1 |
+                       spreadBits(quantize(z[i], 2)) << 2,
+                   static_cast<uint32_t>(i)};
+    }
+  });
+  parallelSort(keys, threads);
+
+  tree.order_.resize(finite);
+  tree.positions_.resize(finite * 3);
+  size_t sortTasks = (finite + kBuildChunk - 1) / kBuildChunk;
+  detail::parallelFor(sortTasks, threads, [&](size_t t) {
+    size_t last = std::min(finite, (t + 1) * kBuildChunk);
+    for (size_t i = t * kBuildChunk; i < last; i++) {
+      uint32_t src = keys[i].index;
+      tree.order_[i] = src;
+      tree.positions_[i * 3] = x[src];
+      tree.positions_[i * 3 + 1] = y[src];
+      tree.positions_[i * 3 + 2] = z[src];
+    }
+  });
+
+  // Split breadth-first: children of a node partition its range by the
+  // next three code bits
+  OctreeNode root{};
+  root.count = static_cast<uint32_t>(finite);
+  tree.nodes_.push_back(root);
+  for (size_t i = 0; i < tree.nodes_.size(); i++) {
+    OctreeNode node = tree.nodes_[i];
+    if (node.count <= tree.leafSize_ || node.level >= kMaxLevel)
+      continue;
+
+    unsigned shift = 3 * (kMaxLevel - 1 - node.level);
+    auto begin = keys.begin() + node.first;
+    auto end = begin + node.count;
+    uint32_t firstChild = static_cast<uint32_t>(tree.nodes_.size());
+    uint8_t childCount = 0;
+    for (uint64_t octant = 0; octant < 8 && begin != end; octant++) {
+      auto split = std::partition_point(begin, end, [&](const MortonKey &k) {
+        return ((k.code >> shift) & 7) <= octant;
+      });
+      if (split != begin) {
+        OctreeNode child{};
+        child.first = static_cast<uint32_t>(begin - keys.begin());
+        child.count = static_cast<uint32_t>(split - begin);
+        child.level = static_cast<uint8_t>(node.level + 1);
+        tree.nodes_.push_back(child);
+        childCount++;
+      }
+      begin = split;
+    }
+    tree.nodes_[i].firstChild = firstChild;
+    tree.nodes_[i].childCount = childCount;
+  }
+
+  // Tight bounds: leaves from their points, then parents from children
+  auto &nodes = tree.nodes_;
+  detail::parallelFor(nodes.size(), threads, [&](size_t i) {
+    OctreeNode &node = nodes[i];
+    if (node.childCount != 0)
+      return;
+    for (int a = 0; a < 3; a++) {
+      node.min[a] = INFINITY;
+      node.max[a] = -INFINITY;
+    }
+    for (uint32_t p = node.first; p < node.first + node.count; p++) {
+      const float *pos = &tree.positions_[static_cast<size_t>(p) * 3];
+      for (int a = 0; a < 3; a++) {
+        node.min[a] = std::min(node.min[a], pos[a]);
+        node.max[a] = std::max(node.max[a], pos[a]);
+      }
+    }
+  });
+  for (size_t i = nodes.size(); i-- > 0;) {
+    OctreeNode &node = nodes[i];
+    if (node.childCount == 0)
+      continue;
+    for (int a = 0; a < 3; a++) {
+      node.min[a] = INFINITY;
+      node.max[a] = -INFINITY;
+    }
+    for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount;
+         c++) {
+      for (int a = 0; a < 3; a++) {
+        node.min[a] = std::min(node.min[a], nodes[c].min[a]);
+        node.max[a] = std::max(node.max[a], nodes[c].max[a]);
+      }
+    }
+  }
+  return tree;
+}
+
+Octree Octree::build(const PCDData &data, const OctreeOptions &options) {
+  const PCDHeader &header = data.header;
+  int axes[3] = {header.findField("x"), header.findField("y"),
+                 header.findField("z")};
+  if (axes[0] < 0 || axes[1] < 0 || axes[2] < 0) {
+    throw std::runtime_error("Octree requires x, y and z fields");
+  }
+
+  // Float columns are used in place, others converted
+  size_t n = data.numPoints();
+  std::vector<float> converted[3];
+  const float *columns[3];
+  for (int a = 0; a < 3; a++) {
+    const FieldData &column = data.fieldData[axes[a]];
+    if (auto floats = std::get_if<std::vector<float>>(&column)) {
+      if (floats->size() != n)
+        throw std::runtime_error("Octree requires decoded x, y and z fields");
+      columns[a] = floats->data();
+      continue;
+    }
+    converted[a] = std::visit(
+        [](const auto &vec) {
+          return std::vector<float>(vec.begin(), vec.end());
+        },
+        column);
+    if (converted[a].size() != n)
+      throw std::runtime_error("Octree requires decoded x, y and z fields");
+    columns[a] = converted[a].data();
+  }
+  return build(columns[0], columns[1], columns[2], n, options);
+}
+
+unsigned Octree::depth() const {
+  unsigned depth = 0;
+  for (const auto &node : nodes_)
+    depth = std::max<unsigned>(depth, node.level);
+  return depth;
+}
+
+size_t Octree::bytes() const {
+  return nodes_.size() * sizeof(OctreeNode) +
+         order_.size() * sizeof(uint32_t) + positions_.size() * sizeof(float);
+}
+
+void Octree::queryBox(const float min[3], const float max[3],
+                      std::vector<uint32_t> &out) const {
+  traverse(
+      nodes_, order_, positions_,
+      [&](const OctreeNode &node) {
+        if (!boxesOverlap(node, min, max))
+          return 0;
+        return boxContains(min, max, node) ? 1 : 2;
+      },
+      [&](const float *p) {
+        return p[0] >= min[0] && p[0] <= max[0] && p[1] >= min[1] &&
+               p[1] <= max[1] && p[2] >= min[2] && p[2] <= max[2];
+      },
+      out);
+}
+
+void Octree::queryRadius(const float center[3], float radius,
+                         std::vector<uint32_t> &out) const {
+  float radiusSq = radius * radius;
+  traverse(
+      nodes_, order_, positions_,
+      [&](const OctreeNode &node) {
+        float nearSq, farSq;
+        boxDistances(node, center, nearSq, farSq);
+        if (nearSq > radiusSq)
+          return 0;
+        return farSq <= radiusSq ? 1 : 2;
+      },
+      [&](const float *p) {
+        float dx = p[0] - center[0], dy = p[1] - center[1],
+              dz = p[2] - center[2];
+        return dx * dx + dy * dy + dz * dz <= radiusSq;
+      },
+      out);
+}
+
+void Octree::save(std::ostream &stream) const {
+  stream.write(kOctreeMagic, kOctreeMagicSize);
+  writePod(stream, leafSize_);
+  writeVector(stream, nodes_);
+  writeVector(stream, order_);
+  writeVector(stream, positions_);
+}
+
+Octree Octree::load(std::istream &stream) {
+  char magic[kOctreeMagicSize];
+  stream.read(magic, sizeof(magic));
+  if (!stream || std::memcmp(magic, kOctreeMagic, kOctreeMagicSize) != 0) {
+    throw std::runtime_error("Not an octree file");
+  }
+
+  Octree tree;
+  readPod(stream, tree.leafSize_);
+  readVector(stream, tree.nodes_);
+  readVector(stream, tree.order_);
+  readVector(stream, tree.positions_);
+  if (!stream || tree.positions_.size() != tree.order_.size() * 3) {
+    throw std::runtime_error("Malformed octree data");
+  }
+  for (size_t i = 0; i < tree.nodes_.size(); i++) {
+    const OctreeNode &node = tree.nodes_[i];
+    bool childrenValid =
+        node.childCount == 0 ||
+        (node.firstChild > i && static_cast<uint64_t>(node.firstChild) +
+                                        node.childCount <=
+                                    tree.nodes_.size());
+    if (static_cast<uint64_t>(node.first) + node.count > tree.order_.size() ||
+        !childrenValid) {
+      throw std::runtime_error("Malformed octree data");
+    }
+  }
+  return tree;
+}
+
+} // namespace pcd
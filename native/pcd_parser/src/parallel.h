@@ -0,0 +1,65 @@
+#ifndef PCD_PARALLEL_H
+#define PCD_PARALLEL_H
+
+// Minimal fork-join helpers for the parser's data-parallel loops
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace pcd {
+namespace detail {
+
+// Resolve a requested thread count (0 = one per hardware thread)
+inline unsigned resolveThreadCount(unsigned requested) {
+  if (requested > 0)
+    return requested;
+  unsigned hw = std::thread::hardware_concurrency();
+  return hw > 0 ? hw : 1;
+}
+
+// Run fn(task) for task in [0, tasks) on up to `threads` threads.
+// The calling thread runs task 0; the first exception thrown is rethrown
+// after all tasks have finished.
+template <typename Fn>
+void parallelFor(size_t tasks, unsigned threads, const Fn &fn) {
+  if (tasks == 0)
+    return;
+
+  size_t workers = std::min<size_t>(tasks, std::max(1u, threads));
+  if (workers == 1) {
+    for (size_t t = 0; t < tasks; t++)
+      fn(t);
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(workers);
+  auto runWorker = [&](size_t w) {
+    try {
+      for (size_t t = w; t < tasks; t += workers)
+        fn(t);
+    } catch (...) {
+      errors[w] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (size_t w = 1; w < workers; w++)
+    pool.emplace_back(runWorker, w);
+  runWorker(0);
+  for (auto &t : pool)
+    t.join();
+
+  for (auto &err : errors) {
+    if (err)
+      std::rethrow_exception(err);
+  }
+}
+
+} // namespace detail
+} // namespace pcd
+
+#endif // PCD_PARALLEL_H
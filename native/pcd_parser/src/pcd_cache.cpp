@@ -0,0 +1,374 @@
+#include "pcd_parser/pcd_cache.h"
+#include "temp_file.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+
+namespace pcd {
+
+// Bookkeeping charged per entry on top of its column bytes
+static constexpr size_t kEntryOverheadBytes = 4096;
+
+static size_t dataBytes(const PCDData &data) {
+  size_t bytes = kEntryOverheadBytes;
+  for (const auto &column : data.fieldData) {
+    bytes += std::visit(
+        [](const auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          return vec.size() * sizeof(T);
+        },
+        column);
+  }
+  return bytes;
+}
+
+// Header fields covered by `options` (all when no subset is given)
+static std::vector<bool> requestedFields(const PCDHeader &header,
+                                         const ParseOptions &options) {
+  std::vector<bool> requested(header.fields.size(), options.fields.empty());
+  for (const auto &name : options.fields) {
+    int idx = header.findField(name);
+    if (idx >= 0)
+      requested[idx] = true;
+  }
+  return requested;
+}
+
+// Modification time and size identifying the current contents of a file
+static bool fileStamp(const std::string &filepath, int64_t &mtime,
+                      uintmax_t &fileSize) {
+  std::error_code ec;
+  auto time = std::filesystem::last_write_time(filepath, ec);
+  fileSize = ec ? 0 : std::filesystem::file_size(filepath, ec);
+  mtime = static_cast<int64_t>(time.time_since_epoch().count());
+  return !ec;
+}
+
+// Persisted octrees: the source path, mtime and size, then Octree::save()
+static std::string persistedOctreePath(const std::string &directory,
+                                       const std::string &filepath) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.octree",
+                static_cast<unsigned long long>(
+                    std::hash<std::string>{}(filepath)));
+  return (std::filesystem::path(directory) / name).string();
+}
+
+static std::shared_ptr<const Octree>
+loadPersistedOctree(const std::string &path, const std::string &filepath,
+                    int64_t mtime, uintmax_t fileSize) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open())
+    return nullptr;
+
+  uint32_t pathLength = 0;
+  int64_t storedMtime = 0;
+  uint64_t storedSize = 0;
+  in.read(reinterpret_cast<char *>(&pathLength), sizeof(pathLength));
+  if (!in || pathLength != filepath.size())
+    return nullptr;
+  std::string storedPath(pathLength, '\0');
+  in.read(&storedPath[0], pathLength);
+  in.read(reinterpret_cast<char *>(&storedMtime), sizeof(storedMtime));
+  in.read(reinterpret_cast<char *>(&storedSize), sizeof(storedSize));
+  if (!in || storedPath != filepath || storedMtime != mtime ||
+      storedSize != fileSize)
+    return nullptr;
+
+  try {
+    return std::make_shared<const Octree>(Octree::load(in));
+  } catch (const std::exception &) {
+    return nullptr; // Rebuilt and overwritten by the caller
+  }
+}
+
+static void savePersistedOctree(const std::string &path,
+                                const std::string &filepath, int64_t mtime,
+                                uintmax_t fileSize, const Octree &tree) {
+  std::string tmpPath = detail::temporaryPathFor(path);
+  {
+    std::ofstream out(tmpPath, std::ios::binary);
+    uint32_t pathLength = static_cast<uint32_t>(filepath.size());
+    uint64_t size = fileSize;
+    out.write(reinterpret_cast<const char *>(&pathLength), sizeof(pathLength));
+    out.write(filepath.data(), pathLength);
+    out.write(reinterpret_cast<const char *>(&mtime), sizeof(mtime));
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    tree.save(out);
+    if (!out) {
+      out.close();
+      std::remove(tmpPath.c_str());
+      return; // Persistence is best effort
+    }
+  }
+  try {
+    detail::replaceFile(tmpPath, path);
+  } catch (const std::exception &) {
+    // Persistence is best effort
+  }
+}
+
+PCDCache::PCDCache(size_t budgetBytes) : budget_(budgetBytes) {}
+
+std::shared_ptr<const PCDData> PCDCache::get(const std::string &filepath,
+                                             const ParseOptions &options) {
+  int64_t mtimeTicks;
+  uintmax_t fileSize;
+  if (!fileStamp(filepath, mtimeTicks, fileSize)) {
+    // Let the parser report the missing or unreadable file
+    return std::make_shared<const PCDData>(PCDParser::parse(filepath, options));
+  }
+
+  // Fields to decode on this call: everything requested on a miss, only the
+  // requested fields the entry lacks on a partial hit
+  ParseOptions missing = options;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(filepath);
+    if (found != index_.end()) {
+      Entry &entry = *found->second;
+      if (entry.mtime == mtimeTicks && entry.fileSize == fileSize) {
+        std::vector<bool> requested =
+            requestedFields(entry.data->header, options);
+        missing.fields.clear();
+        for (size_t f = 0; f < requested.size(); f++) {
+          if (requested[f] && !entry.decoded[f])
+            missing.fields.push_back(entry.data->header.fields[f].name);
+        }
+        if (missing.fields.empty()) {
+          entries_.splice(entries_.begin(), entries_, found->second);
+          hits_++;
+          return entry.data;
+        }
+      } else {
+        eraseLocked(found->second);
+      }
+    }
+    misses_++;
+  }
+
+  // Decode outside the lock
+  PCDData parsed = PCDParser::parse(filepath, missing);
+  std::vector<bool> decoded = requestedFields(parsed.header, missing);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<const Octree> octree;
+  std::shared_ptr<const LodHierarchy> lod;
+  std::shared_ptr<const KdTree> kdTree;
+  auto found = index_.find(filepath);
+  if (found != index_.end()) {
+    Entry &entry = *found->second;
+    bool sameFile = entry.mtime == mtimeTicks && entry.fileSize == fileSize &&
+                    entry.decoded.size() == decoded.size();
+    if (sameFile) {
+      octree = entry.octree;
+      lod = entry.lod;
+      kdTree = entry.kdTree;
+      // Merge the previously decoded columns into the new data. Columns are
+      // moved when no caller still holds the old data, copied otherwise.
+      bool shared = entry.data.use_count() > 1;
+      auto &old = const_cast<PCDData &>(*entry.data);
+      for (size_t f = 0; f < decoded.size(); f++) {
+        if (entry.decoded[f] && !decoded[f]) {
+          parsed.fieldData[f] =
+              shared ? old.fieldData[f] : std::move(old.fieldData[f]);
+          decoded[f] = true;
+        }
+      }
+    }
+    eraseLocked(found->second);
+  }
+
+  Entry entry;
+  entry.path = filepath;
+  entry.mtime = mtimeTicks;
+  entry.fileSize = fileSize;
+  entry.bytes = dataBytes(parsed) + (octree ? octree->bytes() : 0) +
+                (lod ? lod->bytes() : 0) + (kdTree ? kdTree->bytes() : 0);
+  entry.octree = std::move(octree);
+  entry.lod = std::move(lod);
+  entry.kdTree = std::move(kdTree);
+  // Allocated non-const so a later merge may move columns out of it
+  entry.data = std::make_shared<PCDData>(std::move(parsed));
+  entry.decoded = std::move(decoded);
+  std::shared_ptr<const PCDData> result = entry.data;
+
+  // Clouds larger than the whole budget are returned without being cached
+  if (entry.bytes <= budget_) {
+    bytes_ += entry.bytes;
+    entries_.push_front(std::move(entry));
+    index_[filepath] = entries_.begin();
+    evictLocked();
+  }
+  return result;
+}
+
+std::shared_ptr<const Octree> PCDCache::octree(const std::string &filepath) {
+  ParseOptions positions;
+  positions.fields = {"x", "y", "z"};
+  std::shared_ptr<const PCDData> data = get(filepath, positions);
+
+  int64_t mtime;
+  uintmax_t fileSize;
+  bool stamped = fileStamp(filepath, mtime, fileSize);
+  std::string persisted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(filepath);
+    if (stamped && found != index_.end()) {
+      Entry &entry = *found->second;
+      if (entry.mtime == mtime && entry.fileSize == fileSize && entry.octree)
+        return entry.octree;
+    }
+    if (stamped && !octreeDirectory_.empty())
+      persisted = persistedOctreePath(octreeDirectory_, filepath);
+  }
+
+  // Load or build outside the lock
+  std::shared_ptr<const Octree> tree;
+  if (!persisted.empty())
+    tree = loadPersistedOctree(persisted, filepath, mtime, fileSize);
+  if (!tree) {
+    tree = std::make_shared<const Octree>(Octree::build(*data));
+    if (!persisted.empty())
+      savePersistedOctree(persisted, filepath, mtime, fileSize, *tree);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(filepath);
+  if (found != index_.end()) {
+    Entry &entry = *found->second;
+    if (entry.mtime == mtime && entry.fileSize == fileSize && !entry.octree) {
+      entry.octree = tree;
+      entry.bytes += tree->bytes();
+      bytes_ += tree->bytes();
+      evictLocked();
+    }
+  }
+  return tree;
+}
+
+std::shared_ptr<const LodHierarchy>
+PCDCache::lod(const std::string &filepath) {
+  std::shared_ptr<const Octree> tree = octree(filepath);
+
+  int64_t mtime;
+  uintmax_t fileSize;
+  bool stamped = fileStamp(filepath, mtime, fileSize);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(filepath);
+    if (stamped && found != index_.end()) {
+      Entry &entry = *found->second;
+      if (entry.mtime == mtime && entry.fileSize == fileSize && entry.lod)
+        return entry.lod;
+    }
+  }
+
+  // Build outside the lock
+  auto hierarchy =
+      std::make_shared<const LodHierarchy>(LodHierarchy::build(*tree));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(filepath);
+  if (stamped && found != index_.end()) {
+    Entry &entry = *found->second;
+    if (entry.mtime == mtime && entry.fileSize == fileSize && !entry.lod) {
+      entry.lod = hierarchy;
+      entry.bytes += hierarchy->bytes();
+      bytes_ += hierarchy->bytes();
+      evictLocked();
+    }
+  }
+  return hierarchy;
+}
+
+std::shared_ptr<const KdTree>
+PCDCache::kdTree(const std::string &filepath) {
+  std::shared_ptr<const Octree> tree = octree(filepath);
+
+  int64_t mtime;
+  uintmax_t fileSize;
+  bool stamped = fileStamp(filepath, mtime, fileSize);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(filepath);
+    if (stamped && found != index_.end()) {
+      Entry &entry = *found->second;
+      if (entry.mtime == mtime && entry.fileSize == fileSize && entry.kdTree)
+        return entry.kdTree;
+    }
+  }
+
+  // Build outside the lock
+  auto built = std::make_shared<const KdTree>(KdTree::build(*tree));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(filepath);
+  if (stamped && found != index_.end()) {
+    Entry &entry = *found->second;
+    if (entry.mtime == mtime && entry.fileSize == fileSize && !entry.kdTree) {
+      entry.kdTree = built;
+      entry.bytes += built->bytes();
+      bytes_ += built->bytes();
+      evictLocked();
+    }
+  }
+  return built;
+}
+
+void PCDCache::setOctreeDirectory(const std::string &directory) {
+  std::error_code ec;
+  if (!directory.empty())
+    std::filesystem::create_directories(directory, ec);
+  std::lock_guard<std::mutex> lock(mutex_);
+  octreeDirectory_ = directory;
+}
+
+void PCDCache::invalidate(const std::string &filepath) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(filepath);
+  if (found != index_.end()) {
+    eraseLocked(found->second);
+  }
+}
+
+void PCDCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  bytes_ = 0;
+}
+
+void PCDCache::setBudget(size_t budgetBytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_ = budgetBytes;
+  evictLocked();
+}
+
+PCDCache::Stats PCDCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.entries = entries_.size();
+  stats.bytes = bytes_;
+  stats.budget = budget_;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  return stats;
+}
+
+void PCDCache::evictLocked() {
+  while (bytes_ > budget_ && !entries_.empty()) {
+    eraseLocked(std::prev(entries_.end()));
+  }
+}
+
+void PCDCache::eraseLocked(EntryList::iterator it) {
+  bytes_ -= it->bytes;
+  index_.erase(it->path);
+  entries_.erase(it);
+}
+
+} // namespace pcd
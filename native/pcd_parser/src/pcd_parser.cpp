@@ -1,5 +1,11 @@
 #include "pcd_parser/pcd_parser.h"
-#include <iomanip>
+#include "pcd_parser/mapped_file.h"
+#include "ascii_codec.h"
+#include "lzf_stream.h"
+#include "parallel.h"
+#include "temp_file.h"
+#include "transpose.h"
+#include <cstdio>
 #include <iostream>
 
 extern "C" {
@@ -89,295 +95,275 @@ PCDHeader PCDParser::parseHeader(std::istream &stream) {
   return header;
 }
 
-// Helper to push a parsed value into the correct variant vector
-template <typename T> void pushValue(FieldData &data, T value) {
-  if (auto *vec = std::get_if<std::vector<T>>(&data)) {
-    vec->push_back(value);
-  }
-}
+// Minimum ascii chunk per thread when the thread count is automatic
+static constexpr size_t kAsciiMinChunkBytes = 1 << 20;
 
-void PCDParser::parseAsciiData(std::istream &stream, PCDData &data) {
+void PCDParser::parseAsciiData(const char *begin, const char *end,
+                               PCDData &data, unsigned threads,
+                               const std::vector<bool> &decode) {
   const auto &header = data.header;
+  size_t totalBytes = static_cast<size_t>(end - begin);
+
+  // Split the data section into per-thread chunks at newline boundaries.
+  // With the automatic thread count, small inputs stay single-threaded.
+  size_t numChunks = threads;
+  if (threads == 0) {
+    numChunks = std::min<size_t>(detail::resolveThreadCount(0),
+                                 totalBytes / kAsciiMinChunkBytes);
+  }
+  numChunks = std::max<size_t>(numChunks, 1);
+
+  std::vector<const char *> bounds{begin};
+  for (size_t c = 1; c < numChunks; c++) {
+    const char *split = begin + totalBytes * c / numChunks;
+    split = std::max(split, bounds.back());
+    const char *newline =
+        static_cast<const char *>(std::memchr(split, '\n', end - split));
+    split = newline ? newline + 1 : end;
+    bounds.push_back(split);
+  }
+  bounds.push_back(end);
+
+  // Parse every chunk into its own columns
+  size_t expectedPoints = header.points > 0 ? header.points : 0;
+  std::vector<std::vector<FieldData>> chunkColumns(numChunks);
+  auto parseChunk = [&](size_t c) {
+    auto &columns = chunkColumns[c];
+    size_t reserve = expectedPoints * (bounds[c + 1] - bounds[c]) /
+                         std::max<size_t>(totalBytes, 1) +
+                     1;
+    for (size_t f = 0; f < header.fields.size(); f++) {
+      FieldData fd = header.fields[f].createStorage();
+      if (decode[f])
+        std::visit([reserve](auto &vec) { vec.reserve(reserve); }, fd);
+      columns.push_back(std::move(fd));
+    }
+    detail::parseAsciiRange(bounds[c], bounds[c + 1], header.fields, columns,
+                            &decode);
+  };
+  detail::parallelFor(numChunks, static_cast<unsigned>(numChunks), parseChunk);
 
-  // Initialize field data vectors
-  data.fieldData.clear();
-  for (const auto &field : header.fields) {
-    FieldData fd = field.createStorage();
-    // Reserve space
-    std::visit([&header](auto &vec) { vec.reserve(header.points); }, fd);
-    data.fieldData.push_back(std::move(fd));
-  }
-
-  std::string line;
-  while (std::getline(stream, line)) {
-    if (line.empty())
-      continue;
-
-    std::istringstream iss(line);
-    std::string token;
-
-    for (size_t i = 0; i < header.fields.size(); i++) {
-      if (!(iss >> token))
-        break;
-
-      const auto &field = header.fields[i];
-      auto &fd = data.fieldData[i];
-
-      try {
-        switch (field.type) {
-        case 'I':
-          switch (field.size) {
-          case 1:
-            pushValue(fd, static_cast<int8_t>(std::stoi(token)));
-            break;
-          case 2:
-            pushValue(fd, static_cast<int16_t>(std::stoi(token)));
-            break;
-          case 4:
-            pushValue(fd, static_cast<int32_t>(std::stol(token)));
-            break;
-          }
-          break;
-        case 'U':
-          switch (field.size) {
-          case 1:
-            pushValue(fd, static_cast<uint8_t>(std::stoul(token)));
-            break;
-          case 2:
-            pushValue(fd, static_cast<uint16_t>(std::stoul(token)));
-            break;
-          case 4:
-            pushValue(fd, static_cast<uint32_t>(std::stoul(token)));
-            break;
+  // Stitch the chunk columns together in file order
+  data.fieldData = std::move(chunkColumns[0]);
+  for (size_t f = 0; f < data.fieldData.size(); f++) {
+    std::visit(
+        [&](auto &vec) {
+          using Vec = std::decay_t<decltype(vec)>;
+          size_t total = vec.size();
+          for (size_t c = 1; c < numChunks; c++)
+            total += std::get<Vec>(chunkColumns[c][f]).size();
+          size_t offset = vec.size();
+          vec.resize(total);
+          for (size_t c = 1; c < numChunks; c++) {
+            const auto &part = std::get<Vec>(chunkColumns[c][f]);
+            std::copy(part.begin(), part.end(), vec.begin() + offset);
+            offset += part.size();
           }
-          break;
-        case 'F':
-          if (field.size == 4)
-            pushValue(fd, std::stof(token));
-          else if (field.size == 8)
-            pushValue(fd, std::stod(token));
-          break;
-        }
-      } catch (...) {
-        // Push default value on parse error
-        std::visit(
-            [](auto &vec) {
-              using T = typename std::decay_t<decltype(vec)>::value_type;
-              vec.push_back(T{});
-            },
-            fd);
-      }
-    }
+        },
+        data.fieldData[f]);
   }
 }
 
-void PCDParser::parseBinaryData(std::istream &stream, PCDData &data) {
+// Number of records de-interleaved per pass. One block of a typical 16-32
+// byte record layout stays resident in L2 while every field column is filled
+static constexpr size_t kBinaryBlockPoints = 16384;
+
+void PCDParser::parseBinaryData(const uint8_t *begin, size_t size,
+                                PCDData &data,
+                                const std::vector<bool> &decode) {
   const auto &header = data.header;
 
-  // Initialize field data vectors
+  // Only complete records are decoded (truncated files yield fewer points)
+  size_t pointSize = static_cast<size_t>(header.getPointSize());
+  size_t numPoints = header.points > 0 ? static_cast<size_t>(header.points) : 0;
+  numPoints = pointSize > 0 ? std::min(numPoints, size / pointSize) : 0;
+
+  // Initialize field data vectors at their final size and select one
+  // de-interleave kernel per field from its element type and the stride
+  struct FieldKernel {
+    detail::DeinterleaveFn fn = nullptr;
+    size_t srcOffset = 0;
+    uint8_t *dst = nullptr;
+    size_t elemSize = 0;
+  };
+  std::vector<FieldKernel> kernels;
+
   data.fieldData.clear();
-  for (const auto &field : header.fields) {
+  size_t offset = 0;
+  for (size_t f = 0; f < header.fields.size(); f++) {
+    const auto &field = header.fields[f];
     FieldData fd = field.createStorage();
-    std::visit([&header](auto &vec) { vec.reserve(header.points); }, fd);
+    FieldKernel kernel;
+    kernel.srcOffset = offset;
+    std::visit(
+        [&](auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          if (!field.isSupported() || !decode[f])
+            return;
+          vec.resize(numPoints);
+          kernel.fn = detail::selectDeinterleave<T>(pointSize);
+          kernel.dst = reinterpret_cast<uint8_t *>(vec.data());
+          kernel.elemSize = sizeof(T);
+        },
+        fd);
     data.fieldData.push_back(std::move(fd));
-  }
-
-  int pointSize = header.getPointSize();
-  std::vector<char> buffer(pointSize);
-
-  for (int pt = 0; pt < header.points; pt++) {
-    stream.read(buffer.data(), pointSize);
-    if (!stream)
-      break;
+    kernels.push_back(kernel);
+    offset += static_cast<size_t>(field.size) * field.count;
+  }
+
+  // Records of exactly four 32-bit fields (x y z intensity, x y z rgb) are
+  // transposed four at a time with SIMD shuffles
+  bool fourLane = pointSize == 16 && kernels.size() == 4 &&
+                  std::all_of(kernels.begin(), kernels.end(),
+                              [](const FieldKernel &k) {
+                                return k.fn && k.elemSize == 4;
+                              });
+
+  // De-interleave the AoS records block by block into the columns
+  for (size_t first = 0; first < numPoints; first += kBinaryBlockPoints) {
+    size_t count = std::min(kBinaryBlockPoints, numPoints - first);
+    const uint8_t *block = begin + first * pointSize;
+
+    if (fourLane) {
+      detail::deinterleave4x32(block, count, kernels[0].dst + first * 4,
+                               kernels[1].dst + first * 4,
+                               kernels[2].dst + first * 4,
+                               kernels[3].dst + first * 4);
+      continue;
+    }
 
-    int offset = 0;
-    for (size_t i = 0; i < header.fields.size(); i++) {
-      const auto &field = header.fields[i];
-      auto &fd = data.fieldData[i];
-
-      switch (field.type) {
-      case 'I':
-        switch (field.size) {
-        case 1: {
-          int8_t v;
-          std::memcpy(&v, buffer.data() + offset, 1);
-          pushValue(fd, v);
-          break;
-        }
-        case 2: {
-          int16_t v;
-          std::memcpy(&v, buffer.data() + offset, 2);
-          pushValue(fd, v);
-          break;
-        }
-        case 4: {
-          int32_t v;
-          std::memcpy(&v, buffer.data() + offset, 4);
-          pushValue(fd, v);
-          break;
-        }
-        }
-        break;
-      case 'U':
-        switch (field.size) {
-        case 1: {
-          uint8_t v;
-          std::memcpy(&v, buffer.data() + offset, 1);
-          pushValue(fd, v);
-          break;
-        }
-        case 2: {
-          uint16_t v;
-          std::memcpy(&v, buffer.data() + offset, 2);
-          pushValue(fd, v);
-          break;
-        }
-        case 4: {
-          uint32_t v;
-          std::memcpy(&v, buffer.data() + offset, 4);
-          pushValue(fd, v);
-          break;
-        }
-        }
-        break;
-      case 'F':
-        if (field.size == 4) {
-          float v;
-          std::memcpy(&v, buffer.data() + offset, 4);
-          pushValue(fd, v);
-        } else if (field.size == 8) {
-          double v;
-          std::memcpy(&v, buffer.data() + offset, 8);
-          pushValue(fd, v);
-        }
-        break;
+    for (const auto &kernel : kernels) {
+      if (kernel.fn) {
+        kernel.fn(block + kernel.srcOffset, pointSize, count,
+                  kernel.dst + first * kernel.elemSize);
       }
-
-      offset += field.size * field.count;
     }
   }
 }
 
-void PCDParser::parseBinaryCompressedData(std::istream &stream, PCDData &data) {
+void PCDParser::parseBinaryCompressedData(const uint8_t *begin, size_t size,
+                                          PCDData &data,
+                                          const std::vector<bool> &decode) {
   const auto &header = data.header;
 
   // Read compressed and uncompressed sizes
   uint32_t compressedSize, uncompressedSize;
-  stream.read(reinterpret_cast<char *>(&compressedSize), sizeof(uint32_t));
-  stream.read(reinterpret_cast<char *>(&uncompressedSize), sizeof(uint32_t));
-
-  if (!stream) {
+  if (size < 2 * sizeof(uint32_t)) {
     throw std::runtime_error("Failed to read compressed data sizes");
   }
+  std::memcpy(&compressedSize, begin, sizeof(uint32_t));
+  std::memcpy(&uncompressedSize, begin + sizeof(uint32_t), sizeof(uint32_t));
 
-  // Read compressed data
-  std::vector<uint8_t> compressedData(compressedSize);
-  stream.read(reinterpret_cast<char *>(compressedData.data()), compressedSize);
-
-  if (!stream) {
+  // The compressed blob is decoded straight from the mapped file
+  const uint8_t *compressedData = begin + 2 * sizeof(uint32_t);
+  if (compressedSize > size - 2 * sizeof(uint32_t)) {
     throw std::runtime_error("Failed to read compressed data");
   }
 
-  // Decompress
-  std::vector<uint8_t> decompressedData(uncompressedSize);
-  unsigned int actualSize = lzf_decompress(
-      compressedData.data(), static_cast<unsigned int>(compressedSize),
-      decompressedData.data(), static_cast<unsigned int>(uncompressedSize));
+  // PCL stores fields contiguously (all x, then all y, etc.). Size every
+  // column up front and route its byte range of the decompressed stream
+  // straight into it, so no full-size intermediate buffer is needed.
+  struct Segment {
+    uint8_t *dst; // nullptr: bytes are skipped
+    size_t size;
+  };
+  std::vector<Segment> segments;
+  std::vector<std::vector<uint8_t>> packedFields(header.fields.size());
 
-  if (actualSize == 0 || actualSize != uncompressedSize) {
-    throw std::runtime_error("LZF decompression failed");
-  }
-
-  // Initialize field data vectors
+  size_t numPoints = header.points > 0 ? static_cast<size_t>(header.points) : 0;
+  size_t totalBytes = 0;
   data.fieldData.clear();
-  for (const auto &field : header.fields) {
+  for (size_t f = 0; f < header.fields.size(); f++) {
+    const auto &field = header.fields[f];
+    size_t stride = static_cast<size_t>(field.size) * field.count;
+    size_t fieldBytes = stride * numPoints;
+    totalBytes += fieldBytes;
+
     FieldData fd = field.createStorage();
-    std::visit([&header](auto &vec) { vec.reserve(header.points); }, fd);
+    uint8_t *dst = nullptr;
+    if (field.isSupported() && decode[f]) {
+      std::visit(
+          [&](auto &vec) {
+            using T = typename std::decay_t<decltype(vec)>::value_type;
+            vec.resize(numPoints);
+            if (stride == sizeof(T)) {
+              dst = reinterpret_cast<uint8_t *>(vec.data());
+            } else {
+              // COUNT > 1: stage the packed values, keep the first of each
+              packedFields[f].resize(fieldBytes);
+              dst = packedFields[f].data();
+            }
+          },
+          fd);
+    }
     data.fieldData.push_back(std::move(fd));
-  }
-
-  // Parse decompressed data - PCL stores fields contiguously (all x, then all
-  // y, etc.)
+    segments.push_back({dst, fieldBytes});
+  }
+
+  if (totalBytes > uncompressedSize) {
+    throw std::runtime_error(
+        "Compressed data is smaller than the header describes");
+  }
+
+  // Decompress, scattering the output across the column segments
+  size_t segment = 0;
+  size_t segmentOffset = 0;
+  size_t written = 0;
+  auto sink = [&](const uint8_t *bytes, size_t len) {
+    while (len > 0 && segment < segments.size()) {
+      const Segment &seg = segments[segment];
+      size_t n = std::min(len, seg.size - segmentOffset);
+      if (seg.dst)
+        std::memcpy(seg.dst + segmentOffset, bytes, n);
+      bytes += n;
+      len -= n;
+      segmentOffset += n;
+      written += n;
+      if (segmentOffset == seg.size) {
+        segment++;
+        segmentOffset = 0;
+      }
+    }
+  };
+  size_t actualSize =
+      detail::lzfDecompressStream(compressedData, compressedSize, sink);
 
-  // Calculate field offsets in the contiguous layout
-  std::vector<size_t> fieldOffsets;
-  size_t offset = 0;
-  for (const auto &field : header.fields) {
-    fieldOffsets.push_back(offset);
-    offset += static_cast<size_t>(field.size) * field.count * header.points;
+  if (actualSize != uncompressedSize || written != totalBytes) {
+    throw std::runtime_error("LZF decompression failed");
   }
 
-  // Parse each field
   for (size_t f = 0; f < header.fields.size(); f++) {
-    const auto &field = header.fields[f];
-    auto &fd = data.fieldData[f];
-    const uint8_t *fieldData = decompressedData.data() + fieldOffsets[f];
-
-    for (int pt = 0; pt < header.points; pt++) {
-      int fieldOffset = pt * field.size * field.count;
-
-      switch (field.type) {
-      case 'I':
-        switch (field.size) {
-        case 1: {
-          int8_t v;
-          std::memcpy(&v, fieldData + fieldOffset, 1);
-          pushValue(fd, v);
-          break;
-        }
-        case 2: {
-          int16_t v;
-          std::memcpy(&v, fieldData + fieldOffset, 2);
-          pushValue(fd, v);
-          break;
-        }
-        case 4: {
-          int32_t v;
-          std::memcpy(&v, fieldData + fieldOffset, 4);
-          pushValue(fd, v);
-          break;
-        }
-        }
-        break;
-      case 'U':
-        switch (field.size) {
-        case 1: {
-          uint8_t v;
-          std::memcpy(&v, fieldData + fieldOffset, 1);
-          pushValue(fd, v);
-          break;
-        }
-        case 2: {
-          uint16_t v;
-          std::memcpy(&v, fieldData + fieldOffset, 2);
-          pushValue(fd, v);
-          break;
-        }
-        case 4: {
-          uint32_t v;
-          std::memcpy(&v, fieldData + fieldOffset, 4);
-          pushValue(fd, v);
-          break;
-        }
-        }
-        break;
-      case 'F':
-        if (field.size == 4) {
-          float v;
-          std::memcpy(&v, fieldData + fieldOffset, 4);
-          pushValue(fd, v);
-        } else if (field.size == 8) {
-          double v;
-          std::memcpy(&v, fieldData + fieldOffset, 8);
-          pushValue(fd, v);
-        }
-        break;
-      }
-    }
+    if (packedFields[f].empty())
+      continue;
+    size_t stride =
+        static_cast<size_t>(header.fields[f].size) * header.fields[f].count;
+    std::visit(
+        [&](auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          detail::selectDeinterleave<T>(stride)(packedFields[f].data(), stride,
+                                                numPoints, vec.data());
+        },
+        data.fieldData[f]);
   }
 }
 
+std::vector<bool> PCDParser::selectFields(const PCDHeader &header,
+                                          const ParseOptions &options) {
+  std::vector<bool> decode(header.fields.size(), options.fields.empty());
+  for (const auto &name : options.fields) {
+    int idx = header.findField(name);
+    if (idx >= 0)
+      decode[idx] = true;
+  }
+  return decode;
+}
+
 PCDData PCDParser::parse(const std::string &filepath) {
+  return parse(filepath, ParseOptions{});
+}
+
+PCDData PCDParser::parse(const std::string &filepath,
+                         const ParseOptions &options) {
   std::ifstream file(filepath, std::ios::binary);
   if (!file.is_open()) {
     throw std::runtime_error("Failed to open file: " + filepath);
@@ -386,62 +372,149 @@ PCDData PCDParser::parse(const std::string &filepath) {
   PCDData data;
   data.header = parseHeader(file);
 
+  if (data.header.dataType != "ascii" && data.header.dataType != "binary" &&
+      data.header.dataType != "binary_compressed") {
+    throw std::runtime_error("Unknown data format: " + data.header.dataType);
+  }
+
+  // Map the file once and decode straight from the page cache
+  std::streamoff headerEnd = file.tellg();
+  file.close();
+  MappedFile mapped(filepath);
+  size_t dataOffset =
+      headerEnd < 0 ? mapped.size()
+                    : std::min(static_cast<size_t>(headerEnd), mapped.size());
+  const uint8_t *begin = mapped.data() + dataOffset;
+  size_t size = mapped.size() - dataOffset;
+
+  std::vector<bool> decode = selectFields(data.header, options);
   if (data.header.dataType == "ascii") {
-    parseAsciiData(file, data);
+    const char *text = reinterpret_cast<const char *>(begin);
+    parseAsciiData(text, text + size, data, options.threads, decode);
   } else if (data.header.dataType == "binary") {
-    parseBinaryData(file, data);
-  } else if (data.header.dataType == "binary_compressed") {
-    parseBinaryCompressedData(file, data);
+    parseBinaryData(begin, size, data, decode);
   } else {
-    throw std::runtime_error("Unknown data format: " + data.header.dataType);
+    parseBinaryCompressedData(begin, size, data, decode);
   }
 
   return data;
 }
 
-void PCDParser::writeAscii(std::ostream &stream, const PCDData &data) {
-  size_t numPoints = data.numPoints();
+PCDFileInfo PCDParser::probe(const std::string &filepath) {
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open file: " + filepath);
+  }
 
-  for (size_t pt = 0; pt < numPoints; pt++) {
-    for (size_t f = 0; f < data.fieldData.size(); f++) {
-      if (f > 0)
-        stream << " ";
+  PCDFileInfo info;
+  info.header = parseHeader(file);
 
-      std::visit(
-          [&stream, pt](const auto &vec) {
-            if (pt < vec.size()) {
-              using T = typename std::decay_t<decltype(vec)>::value_type;
-              if constexpr (std::is_floating_point_v<T>) {
-                // Use precision 9 for float (IEEE 754 guarantees 9 significant
-                // digits for round-trip) and defaultfloat to use scientific
-                // notation when needed (e.g., for packed RGB values
-                // like 6.17e-39)
-                stream << std::defaultfloat << std::setprecision(9) << vec[pt];
-              } else {
-                stream << static_cast<int64_t>(vec[pt]);
-              }
-            }
-          },
-          data.fieldData[f]);
+  std::streamoff headerEnd = file.tellg();
+  file.clear();
+  file.seekg(0, std::ios::end);
+  info.fileSize = static_cast<size_t>(std::max<std::streamoff>(file.tellg(), 0));
+  info.dataOffset = headerEnd < 0 ? info.fileSize
+                                  : std::min(static_cast<size_t>(headerEnd),
+                                             info.fileSize);
+  info.dataSize = info.fileSize - info.dataOffset;
+
+  return info;
+}
+
+// Points formatted per task by the ascii writer. Each round formats one
+// task per thread and writes the buffers in point order.
+static constexpr size_t kAsciiWritePoints = 32768;
+
+void PCDParser::writeAscii(std::ostream &stream, const PCDData &data) {
+  size_t numPoints = data.numPoints();
+  size_t tasks = (numPoints + kAsciiWritePoints - 1) / kAsciiWritePoints;
+  unsigned threads = detail::resolveThreadCount(0);
+
+  std::vector<std::string> buffers(std::min<size_t>(tasks, threads));
+  for (size_t round = 0; round < tasks; round += buffers.size()) {
+    size_t roundTasks = std::min(buffers.size(), tasks - round);
+    detail::parallelFor(roundTasks, threads, [&](size_t t) {
+      size_t first = (round + t) * kAsciiWritePoints;
+      size_t last = std::min(numPoints, first + kAsciiWritePoints);
+      buffers[t].clear();
+      detail::formatAsciiRange(data.fieldData, first, last, buffers[t]);
+    });
+    for (size_t t = 0; t < roundTasks; t++) {
+      stream.write(buffers[t].data(),
+                   static_cast<std::streamsize>(buffers[t].size()));
     }
-    stream << "\n";
   }
 }
 
 void PCDParser::writeBinary(std::ostream &stream, const PCDData &data) {
   size_t numPoints = data.numPoints();
 
-  for (size_t pt = 0; pt < numPoints; pt++) {
-    for (size_t f = 0; f < data.fieldData.size(); f++) {
-      std::visit(
-          [&stream, pt](const auto &vec) {
-            if (pt < vec.size()) {
-              stream.write(reinterpret_cast<const char *>(&vec[pt]),
-                           sizeof(vec[pt]));
-            }
-          },
-          data.fieldData[f]);
+  // One interleave kernel per column; the record layout follows the column
+  // element types. Columns shorter than numPoints leave zeroed bytes.
+  struct FieldKernel {
+    detail::InterleaveFn fn;
+    const void *src;
+    size_t length;
+    size_t dstOffset;
+    size_t elemSize;
+  };
+  std::vector<FieldKernel> kernels;
+  size_t recordSize = 0;
+  bool ragged = false;
+  for (const auto &column : data.fieldData) {
+    std::visit(
+        [&](const auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          kernels.push_back({nullptr, vec.data(), vec.size(), recordSize,
+                             sizeof(T)});
+          recordSize += sizeof(T);
+          ragged = ragged || vec.size() < numPoints;
+        },
+        column);
+  }
+  for (size_t f = 0; f < kernels.size(); f++) {
+    std::visit(
+        [&](const auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          kernels[f].fn = detail::selectInterleave<T>(recordSize);
+        },
+        data.fieldData[f]);
+  }
+  if (recordSize == 0 || numPoints == 0) {
+    return;
+  }
+
+  bool fourLane = recordSize == 16 && kernels.size() == 4 && !ragged &&
+                  std::all_of(kernels.begin(), kernels.end(),
+                              [](const FieldKernel &k) { return k.elemSize == 4; });
+
+  // Records are assembled one block at a time and written in one call
+  std::vector<uint8_t> block(std::min(numPoints, kBinaryBlockPoints) *
+                             recordSize);
+  for (size_t first = 0; first < numPoints; first += kBinaryBlockPoints) {
+    size_t count = std::min(kBinaryBlockPoints, numPoints - first);
+
+    if (fourLane) {
+      const auto at = [first](const FieldKernel &k) {
+        return static_cast<const uint8_t *>(k.src) + first * 4;
+      };
+      detail::interleave4x32(at(kernels[0]), at(kernels[1]), at(kernels[2]),
+                             at(kernels[3]), count, block.data());
+    } else {
+      if (ragged) {
+        std::fill(block.begin(), block.end(), 0);
+      }
+      for (const auto &kernel : kernels) {
+        size_t available =
+            kernel.length > first ? std::min(count, kernel.length - first) : 0;
+        kernel.fn(static_cast<const uint8_t *>(kernel.src) +
+                      first * kernel.elemSize,
+                  available, block.data() + kernel.dstOffset, recordSize);
+      }
     }
+
+    stream.write(reinterpret_cast<const char *>(block.data()),
+                 static_cast<std::streamsize>(count * recordSize));
   }
 }
 
@@ -499,6 +572,41 @@ void PCDParser::writeBinaryCompressed(std::ostream &stream,
                compressedSize);
 }
 
+// `pointCount` is written verbatim as WIDTH and POINTS (PCDWriter passes a
+// space-padded placeholder it patches once the count is known)
+void PCDParser::writeHeader(std::ostream &stream, const PCDHeader &header,
+                            const std::string &pointCount,
+                            const std::string &format) {
+  stream << "# .PCD v0.7 - Point Cloud Data file format\n";
+  stream << "VERSION " << header.version << "\n";
+
+  stream << "FIELDS";
+  for (const auto &f : header.fields) {
+    stream << " " << f.name;
+  }
+  stream << "\n";
+  stream << "SIZE";
+  for (const auto &f : header.fields) {
+    stream << " " << f.size;
+  }
+  stream << "\n";
+  stream << "TYPE";
+  for (const auto &f : header.fields) {
+    stream << " " << f.type;
+  }
+  stream << "\n";
+  stream << "COUNT";
+  for (const auto &f : header.fields) {
+    stream << " " << f.count;
+  }
+  stream << "\n";
+  stream << "WIDTH " << pointCount << "\n";
+  stream << "HEIGHT 1\n";
+  stream << "VIEWPOINT " << header.viewpoint << "\n";
+  stream << "POINTS " << pointCount << "\n";
+  stream << "DATA " << format << "\n";
+}
+
 void PCDParser::write(const std::string &filepath, const PCDData &data,
                       bool binary) {
   // Default: binary -> binary, !binary -> ascii
@@ -658,52 +766,39 @@ void PCDParser::write(const std::string &filepath, const PCDData &data,
     outputData = packRGBForBinary(data);
   }
 
-  std::ofstream file(filepath, isBinary ? std::ios::binary : std::ios::out);
-  if (!file.is_open()) {
-    throw std::runtime_error("Failed to open file for writing: " + filepath);
-  }
-
-  // Write header
-  file << "# .PCD v0.7 - Point Cloud Data file format\n";
-  file << "VERSION " << outputData.header.version << "\n";
-
-  file << "FIELDS";
-  for (const auto &f : outputData.header.fields) {
-    file << " " << f.name;
-  }
-  file << "\n";
+  // Write to a sibling temp file and rename it over the target, so readers
+  // (including async parses mapping the file) never see a partial file
+  std::string tmpPath = detail::temporaryPathFor(filepath);
+  {
+    std::ofstream file(tmpPath, isBinary ? std::ios::binary : std::ios::out);
+    if (!file.is_open()) {
+      throw std::runtime_error("Failed to open file for writing: " + filepath);
+    }
 
-  file << "SIZE";
-  for (const auto &f : outputData.header.fields) {
-    file << " " << f.size;
-  }
-  file << "\n";
+    try {
+      writeHeader(file, outputData.header,
+                  std::to_string(outputData.numPoints()), format);
 
-  file << "TYPE";
-  for (const auto &f : outputData.header.fields) {
-    file << " " << f.type;
-  }
-  file << "\n";
+      if (format == "binary_compressed") {
+        writeBinaryCompressed(file, outputData);
+      } else if (format == "binary") {
+        writeBinary(file, outputData);
+      } else {
+        writeAscii(file, outputData);
+      }
 
-  file << "COUNT";
-  for (const auto &f : outputData.header.fields) {
-    file << " " << f.count;
+      file.close();
+      if (file.fail()) {
+        throw std::runtime_error("Failed to write file: " + filepath);
+      }
+    } catch (...) {
+      file.close();
+      std::remove(tmpPath.c_str());
+      throw;
+    }
   }
-  file << "\n";
-
-  file << "WIDTH " << outputData.numPoints() << "\n";
-  file << "HEIGHT 1\n";
-  file << "VIEWPOINT " << outputData.header.viewpoint << "\n";
-  file << "POINTS " << outputData.numPoints() << "\n";
-  file << "DATA " << format << "\n";
 
-  if (format == "binary_compressed") {
-    writeBinaryCompressed(file, outputData);
-  } else if (format == "binary") {
-    writeBinary(file, outputData);
-  } else {
-    writeAscii(file, outputData);
-  }
+  detail::replaceFile(tmpPath, filepath);
 }
 
 void PCDParser::updateLabels(
@@ -715,6 +810,11 @@ void PCDParser::updateLabels(
 void PCDParser::updateLabelsWithFormat(const std::string &filepath,
                                        const std::vector<uint32_t> &labels,
                                        const std::string &format) {
+  // Same-format saves of binary files only need the label bytes rewritten
+  if ((format.empty() || format == "binary") && patchLabels(filepath, labels)) {
+    return;
+  }
+
   PCDData data = parse(filepath);
   data.setLabels(labels);
 
@@ -727,6 +827,128 @@ void PCDParser::updateLabelsWithFormat(const std::string &filepath,
   write(filepath, data, outputFormat);
 }
 
+#ifndef _WIN32
+// Record layout of a label column that can be overwritten in place: a DATA
+// binary file with a 4-byte, single-count I/U label field and all POINTS
+// records present
+struct PatchableLabels {
+  size_t numPoints = 0;
+  size_t pointSize = 0;
+  size_t offset = 0; // File offset of the first point's label
+};
+
+static bool findPatchableLabels(const PCDFileInfo &info,
+                                PatchableLabels &layout) {
+  const PCDHeader &header = info.header;
+  if (header.dataType != "binary") {
+    return false;
+  }
+
+  int labelIdx = header.findField("label");
+  if (labelIdx < 0) {
+    return false;
+  }
+  const FieldInfo &field = header.fields[labelIdx];
+  if (field.size != 4 || field.count != 1 ||
+      (field.type != 'U' && field.type != 'I')) {
+    return false;
+  }
+
+  layout.numPoints = header.points > 0 ? static_cast<size_t>(header.points) : 0;
+  layout.pointSize = static_cast<size_t>(header.getPointSize());
+  if (info.dataSize / layout.pointSize < layout.numPoints) {
+    return false;
+  }
+
+  layout.offset = info.dataOffset;
+  for (int f = 0; f < labelIdx; f++) {
+    layout.offset += static_cast<size_t>(header.fields[f].size) *
+                     static_cast<size_t>(header.fields[f].count);
+  }
+  return true;
+}
+#endif
+
+bool PCDParser::patchLabels(const std::string &filepath,
+                            const std::vector<uint32_t> &labels) {
+#ifdef _WIN32
+  // Needs a writable mapping; callers fall back to a full rewrite
+  (void)filepath;
+  (void)labels;
+  return false;
+#else
+  PCDFileInfo info = probe(filepath);
+  PatchableLabels layout;
+  if (!findPatchableLabels(info, layout) || labels.size() != layout.numPoints) {
+    return false;
+  }
+  if (layout.numPoints == 0) {
+    return true;
+  }
+
+  // Labels are stored as raw 32-bit patterns, as write() would store them
+  MappedFile mapped(filepath, MappedFile::Mode::ReadWrite);
+  if (mapped.size() != info.fileSize) {
+    return false; // Changed since probe()
+  }
+  uint8_t *dst = mapped.data() + layout.offset;
+  for (size_t i = 0; i < layout.numPoints; i++) {
+    std::memcpy(dst + i * layout.pointSize, &labels[i], sizeof(uint32_t));
+  }
+  return true;
+#endif
+}
+
+void PCDParser::applyLabelDelta(const std::string &filepath,
+                                const std::vector<LabelRun> &runs,
+                                const std::string &format) {
+  PCDFileInfo info = probe(filepath);
+  size_t numPoints =
+      info.header.points > 0 ? static_cast<size_t>(info.header.points) : 0;
+  for (const auto &run : runs) {
+    if (static_cast<size_t>(run.start) + run.count > numPoints) {
+      throw std::runtime_error("Label run out of range: " +
+                               std::to_string(run.start) + "+" +
+                               std::to_string(run.count));
+    }
+  }
+
+#ifndef _WIN32
+  PatchableLabels layout;
+  if ((format.empty() || format == "binary") &&
+      findPatchableLabels(info, layout)) {
+    if (runs.empty()) {
+      return;
+    }
+    MappedFile mapped(filepath, MappedFile::Mode::ReadWrite);
+    if (mapped.size() == info.fileSize) {
+      uint8_t *dst = mapped.data() + layout.offset;
+      for (const auto &run : runs) {
+        size_t end = static_cast<size_t>(run.start) + run.count;
+        for (size_t i = run.start; i < end; i++) {
+          std::memcpy(dst + i * layout.pointSize, &run.label, sizeof(uint32_t));
+        }
+      }
+      return;
+    }
+    // Changed since probe(): fall through to a full rewrite
+  }
+#endif
+
+  PCDData data = parse(filepath);
+  std::vector<uint32_t> labels = data.getLabels();
+  labels.resize(data.numPoints(), 0);
+  for (const auto &run : runs) {
+    size_t end =
+        std::min(labels.size(), static_cast<size_t>(run.start) + run.count);
+    for (size_t i = run.start; i < end; i++) {
+      labels[i] = run.label;
+    }
+  }
+  data.setLabels(labels);
+  write(filepath, data, format.empty() ? data.header.dataType : format);
+}
+
 void PCDParser::convertFormat(const std::string &filepath,
                               const std::string &format) {
   PCDData data = parse(filepath);
@@ -0,0 +1,80 @@
+#include "pcd_parser/pcd_prefetcher.h"
+#include <algorithm>
+
+namespace pcd {
+
+PCDPrefetcher::PCDPrefetcher(PCDCache &cache, unsigned threads)
+    : cache_(cache) {
+  for (unsigned t = 0; t < std::max(1u, threads); t++) {
+    workers_.emplace_back(&PCDPrefetcher::run, this);
+  }
+}
+
+PCDPrefetcher::~PCDPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    queue_.clear();
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void PCDPrefetcher::schedule(const std::vector<std::string> &paths,
+                             const ParseOptions &options) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.assign(paths.begin(), paths.end());
+    options_ = options;
+  }
+  wake_.notify_all();
+}
+
+void PCDPrefetcher::cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.clear();
+  if (active_ == 0) {
+    idle_.notify_all();
+  }
+}
+
+void PCDPrefetcher::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return queue_.empty() && active_ == 0; });
+}
+
+size_t PCDPrefetcher::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+void PCDPrefetcher::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (stop_)
+      return;
+
+    std::string path = std::move(queue_.front());
+    queue_.pop_front();
+    ParseOptions options = options_;
+    active_++;
+
+    lock.unlock();
+    try {
+      cache_.get(path, options);
+    } catch (const std::exception &) {
+      // Speculative: unreadable files are reported when actually opened
+    }
+    lock.lock();
+
+    active_--;
+    if (queue_.empty() && active_ == 0) {
+      idle_.notify_all();
+    }
+  }
+}
+
+} // namespace pcd
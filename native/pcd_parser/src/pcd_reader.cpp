@@ -0,0 +1,251 @@
+#include "pcd_parser/pcd_reader.h"
+#include "pcd_parser/mapped_file.h"
+#include "ascii_codec.h"
+#include "lzf_stream.h"
+#include "temp_file.h"
+#include "transpose.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace pcd {
+
+// Bytes of ascii text read from the file per refill
+static constexpr size_t kAsciiReadBytes = 1 << 20;
+
+static bool hasToken(const char *begin, const char *end) {
+  for (const char *p = begin; p < end; p++) {
+    if (!detail::isAsciiSpace(*p))
+      return true;
+  }
+  return false;
+}
+
+PCDReader::PCDReader(const std::string &filepath, size_t chunkPoints)
+    : filepath_(filepath), chunkPoints_(std::max<size_t>(chunkPoints, 1)) {
+  file_.open(filepath, std::ios::binary);
+  if (!file_.is_open()) {
+    throw std::runtime_error("Failed to open file: " + filepath);
+  }
+
+  header_ = PCDParser::parseHeader(file_);
+  if (header_.dataType != "ascii" && header_.dataType != "binary" &&
+      header_.dataType != "binary_compressed") {
+    throw std::runtime_error("Unknown data format: " + header_.dataType);
+  }
+
+  dataOffset_ = file_.tellg();
+  if (dataOffset_ < 0) {
+    // Header ran to the end of the file: no data section
+    file_.clear();
+    file_.seekg(0, std::ios::end);
+    dataOffset_ = file_.tellg();
+    textEof_ = true;
+  }
+  totalPoints_ = header_.points > 0 ? static_cast<size_t>(header_.points) : 0;
+}
+
+PCDReader::~PCDReader() {
+  if (spill_.is_open()) {
+    spill_.close();
+  }
+  if (!spillPath_.empty()) {
+    std::remove(spillPath_.c_str());
+  }
+}
+
+bool PCDReader::next(PCDData &chunk) {
+  std::vector<FieldData> columns;
+  columns.reserve(header_.fields.size());
+  for (const auto &field : header_.fields) {
+    columns.push_back(field.createStorage());
+  }
+
+  size_t count = 0;
+  if (header_.dataType == "ascii") {
+    count = readAscii(columns);
+  } else if (header_.dataType == "binary") {
+    count = readBinary(columns);
+  } else {
+    count = readCompressed(columns);
+  }
+
+  if (count == 0) {
+    return false;
+  }
+  chunk.header = header_;
+  chunk.fieldData = std::move(columns);
+  pointsRead_ += count;
+  return true;
+}
+
+size_t PCDReader::readAscii(std::vector<FieldData> &columns) {
+  // Find the end of the next chunkPoints records, reading more text as
+  // needed. Lines without tokens are skipped, as in PCDParser::parse().
+  size_t lines = 0;
+  size_t pos = textPos_;
+  while (lines < chunkPoints_) {
+    const char *base = text_.data();
+    const char *newline = static_cast<const char *>(
+        std::memchr(base + pos, '\n', text_.size() - pos));
+    if (newline) {
+      if (hasToken(base + pos, newline))
+        lines++;
+      pos = static_cast<size_t>(newline - base) + 1;
+      continue;
+    }
+
+    if (textEof_) {
+      // Final line without a trailing newline
+      if (hasToken(base + pos, base + text_.size()))
+        lines++;
+      pos = text_.size();
+      break;
+    }
+
+    // Drop consumed text and append the next block
+    text_.erase(0, textPos_);
+    pos -= textPos_;
+    textPos_ = 0;
+    size_t used = text_.size();
+    text_.resize(used + kAsciiReadBytes);
+    file_.read(&text_[used], static_cast<std::streamsize>(kAsciiReadBytes));
+    text_.resize(used + static_cast<size_t>(file_.gcount()));
+    textEof_ = !file_;
+  }
+
+  if (lines > 0) {
+    detail::parseAsciiRange(text_.data() + textPos_, text_.data() + pos,
+                            header_.fields, columns);
+  }
+  textPos_ = pos;
+  return lines;
+}
+
+size_t PCDReader::readBinary(std::vector<FieldData> &columns) {
+  size_t pointSize = static_cast<size_t>(header_.getPointSize());
+  if (pointSize == 0 || pointsRead_ >= totalPoints_) {
+    return 0;
+  }
+
+  // Only complete records are decoded (truncated files yield fewer points)
+  size_t wanted = std::min(chunkPoints_, totalPoints_ - pointsRead_);
+  records_.resize(wanted * pointSize);
+  file_.read(reinterpret_cast<char *>(records_.data()),
+             static_cast<std::streamsize>(records_.size()));
+  size_t count = static_cast<size_t>(file_.gcount()) / pointSize;
+  if (count < wanted) {
+    totalPoints_ = pointsRead_ + count;
+  }
+
+  size_t offset = 0;
+  for (size_t f = 0; f < header_.fields.size(); f++) {
+    const auto &field = header_.fields[f];
+    if (field.isSupported()) {
+      std::visit(
+          [&](auto &vec) {
+            using T = typename std::decay_t<decltype(vec)>::value_type;
+            vec.resize(count);
+            detail::selectDeinterleave<T>(pointSize)(
+                records_.data() + offset, pointSize, count, vec.data());
+          },
+          columns[f]);
+    }
+    offset += static_cast<size_t>(field.size) * field.count;
+  }
+  return count;
+}
+
+void PCDReader::spillCompressed() {
+  MappedFile mapped(filepath_);
+  size_t dataOffset = std::min(static_cast<size_t>(dataOffset_), mapped.size());
+  const uint8_t *begin = mapped.data() + dataOffset;
+  size_t size = mapped.size() - dataOffset;
+
+  uint32_t compressedSize, uncompressedSize;
+  if (size < 2 * sizeof(uint32_t)) {
+    throw std::runtime_error("Failed to read compressed data sizes");
+  }
+  std::memcpy(&compressedSize, begin, sizeof(uint32_t));
+  std::memcpy(&uncompressedSize, begin + sizeof(uint32_t), sizeof(uint32_t));
+  if (compressedSize > size - 2 * sizeof(uint32_t)) {
+    throw std::runtime_error("Failed to read compressed data");
+  }
+
+  // PCL stores fields contiguously (all x, then all y, etc.)
+  std::streamoff totalBytes = 0;
+  for (const auto &field : header_.fields) {
+    columnOffsets_.push_back(totalBytes);
+    totalBytes += static_cast<std::streamoff>(field.size) * field.count *
+                  static_cast<std::streamoff>(totalPoints_);
+  }
+  if (totalBytes > static_cast<std::streamoff>(uncompressedSize)) {
+    throw std::runtime_error(
+        "Compressed data is smaller than the header describes");
+  }
+
+  spillPath_ = detail::temporaryPathFor(
+      (std::filesystem::temp_directory_path() / "pcd_reader").string());
+  spill_.open(spillPath_, std::ios::in | std::ios::out | std::ios::trunc |
+                              std::ios::binary);
+  if (!spill_.is_open()) {
+    throw std::runtime_error("Failed to create temporary file: " + spillPath_);
+  }
+
+  size_t actualSize = detail::lzfDecompressStream(
+      begin + 2 * sizeof(uint32_t), compressedSize,
+      [this](const uint8_t *bytes, size_t len) {
+        spill_.write(reinterpret_cast<const char *>(bytes),
+                     static_cast<std::streamsize>(len));
+      });
+  if (actualSize != uncompressedSize) {
+    throw std::runtime_error("LZF decompression failed");
+  }
+  if (!spill_) {
+    throw std::runtime_error("Failed to write temporary file: " + spillPath_);
+  }
+}
+
+size_t PCDReader::readCompressed(std::vector<FieldData> &columns) {
+  if (pointsRead_ >= totalPoints_) {
+    return 0;
+  }
+  if (!spill_.is_open()) {
+    spillCompressed();
+  }
+
+  size_t count = std::min(chunkPoints_, totalPoints_ - pointsRead_);
+  for (size_t f = 0; f < header_.fields.size(); f++) {
+    const auto &field = header_.fields[f];
+    if (!field.isSupported())
+      continue;
+
+    size_t stride = static_cast<size_t>(field.size) * field.count;
+    spill_.seekg(columnOffsets_[f] +
+                 static_cast<std::streamoff>(pointsRead_ * stride));
+    std::visit(
+        [&](auto &vec) {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          vec.resize(count);
+          if (stride == sizeof(T)) {
+            spill_.read(reinterpret_cast<char *>(vec.data()),
+                        static_cast<std::streamsize>(count * stride));
+          } else {
+            // COUNT > 1: keep the first value of each point
+            staging_.resize(count * stride);
+            spill_.read(reinterpret_cast<char *>(staging_.data()),
+                        static_cast<std::streamsize>(staging_.size()));
+            detail::selectDeinterleave<T>(stride)(staging_.data(), stride,
+                                                  count, vec.data());
+          }
+        },
+        columns[f]);
+    if (!spill_) {
+      throw std::runtime_error("Failed to read temporary file: " + spillPath_);
+    }
+  }
+  return count;
+}
+
+} // namespace pcd
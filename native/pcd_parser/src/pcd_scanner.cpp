@@ -0,0 +1,111 @@
+#include "pcd_parser/pcd_scanner.h"
+#include "parallel.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace pcd {
+
+// Files probed per parallel task
+static constexpr size_t kProbeBatch = 64;
+
+static bool isPcdName(const std::string &name) {
+  if (name.size() < 4)
+    return false;
+  std::string ext = name.substr(name.size() - 4);
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  return ext == ".pcd";
+}
+
+ScanResult PCDScanner::scan(const std::string &root,
+                            const ScanOptions &options) {
+  ScanResult result;
+  fs::path rootPath(root);
+
+  // Shared work queue of directories (relative, "" = root). Workers exit
+  // once the queue is empty and no directory is being listed, since only a
+  // listing can add work.
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::string> pending{""};
+  size_t listing = 0;
+
+  auto worker = [&](size_t) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock, [&] { return !pending.empty() || listing == 0; });
+      if (pending.empty())
+        return;
+      std::string dir = std::move(pending.front());
+      pending.pop_front();
+      listing++;
+      lock.unlock();
+
+      std::vector<std::string> subdirs, files;
+      std::error_code ec;
+      for (fs::directory_iterator it(rootPath / dir, ec), end; !ec && it != end;
+           it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (name.empty() || name[0] == '.')
+          continue;
+        std::string relative = dir.empty() ? name : dir + "/" + name;
+        std::error_code typeEc;
+        if (it->symlink_status(typeEc).type() == fs::file_type::directory) {
+          subdirs.push_back(std::move(relative));
+        } else if (isPcdName(name)) {
+          files.push_back(std::move(relative));
+        }
+      }
+
+      lock.lock();
+      for (auto &file : files) {
+        result.files.emplace_back();
+        result.files.back().path = std::move(file);
+      }
+      for (auto &subdir : subdirs) {
+        if (options.recursive)
+          pending.push_back(subdir);
+        result.directories.push_back(std::move(subdir));
+      }
+      listing--;
+      changed.notify_all();
+    }
+  };
+  unsigned threads = std::max(1u, options.threads);
+  detail::parallelFor(threads, threads, worker);
+
+  std::sort(result.directories.begin(), result.directories.end());
+  std::sort(result.files.begin(), result.files.end(),
+            [](const ScannedFile &a, const ScannedFile &b) {
+              return a.path < b.path;
+            });
+
+  if (options.probe) {
+    probe(root, result.files, options.threads);
+  }
+  return result;
+}
+
+void PCDScanner::probe(const std::string &root,
+                       std::vector<ScannedFile> &files, unsigned threads) {
+  fs::path rootPath(root);
+  size_t tasks = (files.size() + kProbeBatch - 1) / kProbeBatch;
+  detail::parallelFor(tasks, std::max(1u, threads), [&](size_t t) {
+    size_t last = std::min(files.size(), (t + 1) * kProbeBatch);
+    for (size_t i = t * kProbeBatch; i < last; i++) {
+      try {
+        files[i].info = PCDParser::probe((rootPath / files[i].path).string());
+        files[i].probed = true;
+      } catch (const std::exception &) {
+        files[i].probed = false; // Unreadable or malformed header
+      }
+    }
+  });
+}
+
+} // namespace pcd
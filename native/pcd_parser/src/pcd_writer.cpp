@@ -0,0 +1,211 @@
+#include "pcd_parser/pcd_writer.h"
+#include "temp_file.h"
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+extern "C" {
+#include <lzf.h>
+}
+
+namespace pcd {
+
+// WIDTH / POINTS are reserved at this width and patched on close()
+static constexpr size_t kCountSlotWidth = 20;
+
+// Uncompressed bytes per LZF block. LZF back-references never cross a block,
+// so independently compressed blocks concatenate into one valid stream.
+static constexpr size_t kCompressBlockBytes = 1 << 20;
+
+static std::string countSlot(size_t count) {
+  std::string text = std::to_string(count);
+  text.resize(kCountSlotWidth, ' ');
+  return text;
+}
+
+PCDWriter::PCDWriter(const std::string &filepath, const PCDHeader &header,
+                     const std::string &format)
+    : filepath_(filepath), header_(header), format_(format) {
+  if (format != "ascii" && format != "binary" &&
+      format != "binary_compressed") {
+    throw std::runtime_error("Unknown data format: " + format);
+  }
+
+  tmpPath_ = detail::temporaryPathFor(filepath);
+  out_.open(tmpPath_, std::ios::binary);
+  if (!out_.is_open()) {
+    throw std::runtime_error("Failed to open file for writing: " + filepath);
+  }
+
+  // Render the header once to locate the count slots
+  std::ostringstream text;
+  PCDParser::writeHeader(text, header_, countSlot(0), format_);
+  std::string headerText = text.str();
+  widthSlot_ = static_cast<std::streamoff>(headerText.find("\nWIDTH ") + 7);
+  pointsSlot_ = static_cast<std::streamoff>(headerText.find("\nPOINTS ") + 8);
+  out_.write(headerText.data(), static_cast<std::streamsize>(headerText.size()));
+
+  if (format_ == "binary_compressed") {
+    for (size_t f = 0; f < header_.fields.size(); f++) {
+      columnPaths_.push_back(tmpPath_ + ".f" + std::to_string(f));
+      columnFiles_.emplace_back(columnPaths_.back(), std::ios::binary);
+      if (!columnFiles_.back().is_open()) {
+        discard();
+        throw std::runtime_error("Failed to create temporary file: " +
+                                 columnPaths_.back());
+      }
+    }
+  }
+}
+
+PCDWriter::~PCDWriter() {
+  if (!closed_) {
+    discard();
+  }
+}
+
+void PCDWriter::discard() {
+  closed_ = true;
+  out_.close();
+  std::remove(tmpPath_.c_str());
+  for (size_t f = 0; f < columnPaths_.size(); f++) {
+    if (f < columnFiles_.size())
+      columnFiles_[f].close();
+    std::remove(columnPaths_[f].c_str());
+  }
+}
+
+void PCDWriter::checkChunk(const PCDData &chunk) const {
+  if (chunk.fieldData.size() != header_.fields.size()) {
+    throw std::runtime_error("Chunk does not match the writer's fields");
+  }
+  size_t count = chunk.numPoints();
+  for (size_t f = 0; f < header_.fields.size(); f++) {
+    const FieldData &column = chunk.fieldData[f];
+    size_t size = std::visit([](const auto &vec) { return vec.size(); }, column);
+    if (size != count ||
+        column.index() != header_.fields[f].createStorage().index()) {
+      throw std::runtime_error("Chunk does not match the writer's fields");
+    }
+  }
+}
+
+void PCDWriter::append(const PCDData &chunk) {
+  if (closed_) {
+    throw std::runtime_error("PCDWriter is closed");
+  }
+  checkChunk(chunk);
+
+  if (format_ == "ascii") {
+    PCDParser::writeAscii(out_, chunk);
+  } else if (format_ == "binary") {
+    PCDParser::writeBinary(out_, chunk);
+  } else {
+    for (size_t f = 0; f < chunk.fieldData.size(); f++) {
+      std::visit(
+          [&](const auto &vec) {
+            using T = typename std::decay_t<decltype(vec)>::value_type;
+            columnFiles_[f].write(reinterpret_cast<const char *>(vec.data()),
+                                  static_cast<std::streamsize>(vec.size() *
+                                                               sizeof(T)));
+          },
+          chunk.fieldData[f]);
+    }
+  }
+  points_ += chunk.numPoints();
+}
+
+void PCDWriter::writeCompressedData() {
+  uint64_t uncompressedTotal = 0;
+  for (auto &column : columnFiles_) {
+    column.close();
+    if (column.fail()) {
+      throw std::runtime_error("Failed to write temporary file for: " +
+                               filepath_);
+    }
+  }
+  for (const auto &field : header_.fields) {
+    FieldData storage = field.createStorage();
+    size_t elemSize = std::visit(
+        [](const auto &vec) {
+          return sizeof(typename std::decay_t<decltype(vec)>::value_type);
+        },
+        storage);
+    uncompressedTotal += static_cast<uint64_t>(elemSize) * points_;
+  }
+  if (uncompressedTotal > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error(
+        "binary_compressed data is limited to 4 GiB uncompressed");
+  }
+
+  // Sizes are patched once the compressed length is known
+  std::streamoff sizesPos = out_.tellp();
+  uint32_t sizes[2] = {0, static_cast<uint32_t>(uncompressedTotal)};
+  out_.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+
+  std::vector<char> input(kCompressBlockBytes);
+  std::vector<char> output(kCompressBlockBytes + kCompressBlockBytes / 16 + 64);
+  uint64_t compressedTotal = 0;
+  for (const auto &path : columnPaths_) {
+    std::ifstream column(path, std::ios::binary);
+    while (column) {
+      column.read(input.data(), static_cast<std::streamsize>(input.size()));
+      size_t got = static_cast<size_t>(column.gcount());
+      if (got == 0)
+        break;
+      unsigned int produced = lzf_compress(
+          input.data(), static_cast<unsigned int>(got), output.data(),
+          static_cast<unsigned int>(output.size()));
+      if (produced == 0) {
+        throw std::runtime_error("LZF compression failed");
+      }
+      out_.write(output.data(), produced);
+      compressedTotal += produced;
+    }
+  }
+  if (compressedTotal > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error(
+        "binary_compressed data is limited to 4 GiB compressed");
+  }
+
+  std::streamoff end = out_.tellp();
+  sizes[0] = static_cast<uint32_t>(compressedTotal);
+  out_.seekp(sizesPos);
+  out_.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+  out_.seekp(end);
+}
+
+void PCDWriter::close() {
+  if (closed_) {
+    throw std::runtime_error("PCDWriter is closed");
+  }
+
+  try {
+    if (format_ == "binary_compressed") {
+      writeCompressedData();
+    }
+
+    std::string slot = countSlot(points_);
+    out_.seekp(widthSlot_);
+    out_.write(slot.data(), static_cast<std::streamsize>(slot.size()));
+    out_.seekp(pointsSlot_);
+    out_.write(slot.data(), static_cast<std::streamsize>(slot.size()));
+
+    out_.close();
+    if (out_.fail()) {
+      throw std::runtime_error("Failed to write file: " + filepath_);
+    }
+  } catch (...) {
+    discard();
+    throw;
+  }
+
+  closed_ = true;
+  for (const auto &path : columnPaths_) {
+    std::remove(path.c_str());
+  }
+  detail::replaceFile(tmpPath_, filepath_);
+}
+
+} // namespace pcd
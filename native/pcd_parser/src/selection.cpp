@@ -0,0 +1,313 @@
+#include "pcd_parser/selection.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pcd {
+
+// Points per parallel task (a multiple of 8 so tasks own whole bitset bytes)
+static constexpr size_t kSelectChunk = 1 << 14;
+// Points projected together; the projection loop has no branches so the
+// compiler can vectorize it
+static constexpr size_t kProjectBatch = 256;
+// Slack, in cells, absorbing rounding when marking edges and node bounds
+static constexpr float kCellSlack = 1e-3f;
+
+PolygonSelector::PolygonSelector(const SelectionView &view,
+                                 std::vector<ScreenPoint> polygon)
+    : view_(view), polygon_(std::move(polygon)) {
+  for (const auto &p : polygon_) {
+    if (!std::isfinite(p.x) || !std::isfinite(p.y))
+      throw std::runtime_error("Selection polygon has non-finite coordinates");
+  }
+  if (polygon_.size() >= 3)
+    rasterize();
+}
+
+bool PolygonSelector::contains(float x, float y) const {
+  // Same ray-casting rule as the viewer's JavaScript fallback
+  bool inside = false;
+  size_t n = polygon_.size();
+  for (size_t i = 0, j = n - 1; i < n; j = i++) {
+    double xi = polygon_[i].x, yi = polygon_[i].y;
+    double xj = polygon_[j].x, yj = polygon_[j].y;
+    if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+      inside = !inside;
+  }
+  return inside;
+}
+
+void PolygonSelector::rasterize() {
+  float minX = polygon_[0].x, maxX = minX;
+  float minY = polygon_[0].y, maxY = minY;
+  for (const auto &p : polygon_) {
+    minX = std::min(minX, p.x);
+    maxX = std::max(maxX, p.x);
+    minY = std::min(minY, p.y);
+    maxY = std::max(maxY, p.y);
+  }
+  float extent = std::max(maxX - minX, maxY - minY);
+  originX_ = minX;
+  originY_ = minY;
+  cellSize_ = std::max(1.0f, extent / (kMaxMaskSize - 1));
+  cols_ = std::min(kMaxMaskSize,
+                   static_cast<int>((maxX - minX) / cellSize_) + 1);
+  rows_ = std::min(kMaxMaskSize,
+                   static_cast<int>((maxY - minY) / cellSize_) + 1);
+  cells_.assign(static_cast<size_t>(cols_) * rows_, Outside);
+
+  // Scanline fill at cell centers: inside between crossings 2k and 2k + 1
+  std::vector<float> crossings;
+  size_t n = polygon_.size();
+  for (int r = 0; r < rows_; r++) {
+    float y = originY_ + (r + 0.5f) * cellSize_;
+    crossings.clear();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+      const ScreenPoint &a = polygon_[i], &b = polygon_[j];
+      if ((a.y > y) != (b.y > y))
+        crossings.push_back((b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x);
+    }
+    std::sort(crossings.begin(), crossings.end());
+    uint8_t *row = &cells_[static_cast<size_t>(r) * cols_];
+    for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+      float from = (crossings[k] - originX_) / cellSize_ - 0.5f;
+      float to = (crossings[k + 1] - originX_) / cellSize_ - 0.5f;
+      int first = std::max(0, static_cast<int>(std::ceil(from)));
+      int last = std::min(cols_ - 1, static_cast<int>(std::ceil(to)) - 1);
+      for (int c = first; c <= last; c++)
+        row[c] = Inside;
+    }
+  }
+
+  // Every cell an edge passes through needs the exact test
+  for (size_t i = 0, j = n - 1; i < n; j = i++) {
+    float x0 = (polygon_[j].x - originX_) / cellSize_;
+    float y0 = (polygon_[j].y - originY_) / cellSize_;
+    float x1 = (polygon_[i].x - originX_) / cellSize_;
+    float y1 = (polygon_[i].y - originY_) / cellSize_;
+    if (y0 > y1) {
+      std::swap(x0, x1);
+      std::swap(y0, y1);
+    }
+    int firstRow = std::max(0, static_cast<int>(y0 - kCellSlack));
+    int lastRow = std::min(rows_ - 1, static_cast<int>(y1 + kCellSlack));
+    for (int r = firstRow; r <= lastRow; r++) {
+      // Part of the edge within this row
+      float xa = x0, xb = x1;
+      if (y1 > y0) {
+        float ya = std::max(y0, static_cast<float>(r));
+        float yb = std::min(y1, static_cast<float>(r + 1));
+        xa = x0 + (x1 - x0) * (ya - y0) / (y1 - y0);
+        xb = x0 + (x1 - x0) * (yb - y0) / (y1 - y0);
+      }
+      int first = std::max(0, static_cast<int>(std::min(xa, xb) - kCellSlack));
+      int last = std::min(cols_ - 1,
+                          static_cast<int>(std::max(xa, xb) + kCellSlack));
+      uint8_t *row = &cells_[static_cast<size_t>(r) * cols_];
+      for (int c = first; c <= last; c++)
+        row[c] = Edge;
+    }
+  }
+
+  size_t stride = static_cast<size_t>(cols_) + 1;
+  notInside_.assign(stride * (rows_ + 1), 0);
+  notOutside_.assign(stride * (rows_ + 1), 0);
+  for (int r = 0; r < rows_; r++) {
+    for (int c = 0; c < cols_; c++) {
+      uint8_t cell = cells_[static_cast<size_t>(r) * cols_ + c];
+      size_t at = (r + 1) * stride + c + 1;
+      notInside_[at] = (cell != Inside) + notInside_[at - 1] +
+                       notInside_[at - stride] - notInside_[at - stride - 1];
+      notOutside_[at] = (cell != Outside) + notOutside_[at - 1] +
+                        notOutside_[at - stride] -
+                        notOutside_[at - stride - 1];
+    }
+  }
+}
+
+uint32_t PolygonSelector::countOther(const std::vector<uint32_t> &table,
+                                     int x0, int y0, int x1, int y1) const {
+  size_t stride = static_cast<size_t>(cols_) + 1;
+  return table[(y1 + 1) * stride + x1 + 1] - table[y0 * stride + x1 + 1] -
+         table[(y1 + 1) * stride + x0] + table[y0 * stride + x0];
+}
+
+void PolygonSelector::testPoints(const float *xyz, size_t count,
+                                 uint8_t *hits) const {
+  const float *m = view_.matrix;
+  float halfWidth = view_.width * 0.5f, halfHeight = view_.height * 0.5f;
+  float centerX = view_.left + halfWidth, centerY = view_.top + halfHeight;
+  float invCell = 1.0f / cellSize_;
+
+  float sx[kProjectBatch], sy[kProjectBatch];
+  uint8_t front[kProjectBatch];
+  for (size_t start = 0; start < count; start += kProjectBatch) {
+    size_t batch = std::min(kProjectBatch, count - start);
+    const float *p = xyz + start * 3;
+    for (size_t i = 0; i < batch; i++) {
+      float x = p[i * 3], y = p[i * 3 + 1], z = p[i * 3 + 2];
+      float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+      float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+      float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+      float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+      float invW = 1.0f / cw;
+      sx[i] = centerX + cx * invW * halfWidth;
+      sy[i] = centerY - cy * invW * halfHeight;
+      front[i] = (cw > 0) & (cz <= cw);
+    }
+
+    for (size_t i = 0; i < batch; i++) {
+      uint8_t hit = 0;
+      if (front[i]) {
+        float gx = (sx[i] - originX_) * invCell;
+        float gy = (sy[i] - originY_) * invCell;
+        if (gx >= 0 && gx < cols_ && gy >= 0 && gy < rows_) {
+          uint8_t cell = cells_[static_cast<size_t>(gy) * cols_ +
+                                static_cast<size_t>(gx)];
+          hit = cell == Inside || (cell == Edge && contains(sx[i], sy[i]));
+        }
+      }
+      hits[start + i] = hit;
+    }
+  }
+}
+
+int PolygonSelector::classifyNode(const OctreeNode &node) const {
+  const float *m = view_.matrix;
+  float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+  int behind = 0, beyond = 0;
+  for (int corner = 0; corner < 8; corner++) {
+    float x = corner & 1 ? node.max[0] : node.min[0];
+    float y = corner & 2 ? node.max[1] : node.min[1];
+    float z = corner & 4 ? node.max[2] : node.min[2];
+    float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+    if (cw <= 0) {
+      behind++;
+      continue;
+    }
+    if (cz > cw) {
+      beyond++;
+      continue;
+    }
+    float sx = view_.left + (cx / cw * 0.5f + 0.5f) * view_.width;
+    float sy = view_.top + (-cy / cw * 0.5f + 0.5f) * view_.height;
+    minX = std::min(minX, sx);
+    maxX = std::max(maxX, sx);
+    minY = std::min(minY, sy);
+    maxY = std::max(maxY, sy);
+  }
+  // Clip-space w and z - w are linear, so whole boxes behind the camera or
+  // beyond the far plane are culled from their corners
+  if (behind == 8 || beyond == 8)
+    return 0;
+  // Straddling the near or far plane: the screen bounds are unknown
+  if (behind > 0 || beyond > 0)
+    return 2;
+
+  float invCell = 1.0f / cellSize_;
+  float gx0 = (minX - originX_) * invCell - kCellSlack;
+  float gx1 = (maxX - originX_) * invCell + kCellSlack;
+  float gy0 = (minY - originY_) * invCell - kCellSlack;
+  float gy1 = (maxY - originY_) * invCell + kCellSlack;
+  if (!(gx1 >= 0 && gx0 < cols_ && gy1 >= 0 && gy0 < rows_))
+    return 0;
+
+  bool withinMask = gx0 >= 0 && gx1 < cols_ && gy0 >= 0 && gy1 < rows_;
+  // Clamp before converting: bounds near the camera plane can be huge
+  int c0 = static_cast<int>(std::max(0.0f, gx0));
+  int c1 = static_cast<int>(std::min(static_cast<float>(cols_ - 1), gx1));
+  int r0 = static_cast<int>(std::max(0.0f, gy0));
+  int r1 = static_cast<int>(std::min(static_cast<float>(rows_ - 1), gy1));
+  if (withinMask && countOther(notInside_, c0, r0, c1, r1) == 0)
+    return 1;
+  if (countOther(notOutside_, c0, r0, c1, r1) == 0)
+    return 0;
+  return 2;
+}
+
+std::vector<uint8_t> PolygonSelector::select(const float *xyz, size_t n,
+                                             unsigned threads) const {
+  std::vector<uint8_t> bits((n + 7) / 8, 0);
+  if (cells_.empty() || n == 0)
+    return bits;
+
+  size_t tasks = (n + kSelectChunk - 1) / kSelectChunk;
+  detail::parallelFor(
+      tasks, detail::resolveThreadCount(threads), [&](size_t task) {
+        size_t first = task * kSelectChunk;
+        size_t count = std::min(kSelectChunk, n - first);
+        std::vector<uint8_t> hits(count);
+        testPoints(xyz + first * 3, count, hits.data());
+        uint8_t *out = &bits[first / 8];
+        for (size_t i = 0; i < count; i++)
+          out[i >> 3] |= static_cast<uint8_t>(hits[i] << (i & 7));
+      });
+  return bits;
+}
+
+std::vector<uint8_t> PolygonSelector::select(const Octree &tree,
+                                             size_t numPoints,
+                                             unsigned threads) const {
+  std::vector<uint8_t> bits((numPoints + 7) / 8, 0);
+  const auto &nodes = tree.nodes();
+  const auto &order = tree.order();
+  if (cells_.empty() || nodes.empty())
+    return bits;
+
+  auto setBit = [&](uint32_t index) {
+    if (index < numPoints)
+      bits[index >> 3] |= static_cast<uint8_t>(1u << (index & 7));
+  };
+
+  // Nodes wholly inside are taken at once; points of leaves that straddle
+  // the polygon are tested afterwards in parallel, in chunks of the sorted
+  // positions
+  struct Range {
+    uint32_t first;
+    uint32_t count;
+  };
+  std::vector<Range> pending;
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    const OctreeNode &node = nodes[stack.back()];
+    stack.pop_back();
+    int action = classifyNode(node);
+    if (action == 0)
+      continue;
+    if (action == 1) {
+      for (uint32_t i = node.first; i < node.first + node.count; i++)
+        setBit(order[i]);
+    } else if (node.childCount == 0) {
+      for (uint32_t offset = 0; offset < node.count; offset += kSelectChunk) {
+        uint32_t count = static_cast<uint32_t>(
+            std::min<size_t>(kSelectChunk, node.count - offset));
+        pending.push_back({node.first + offset, count});
+      }
+    } else {
+      for (uint32_t c = 0; c < node.childCount; c++)
+        stack.push_back(node.firstChild + c);
+    }
+  }
+
+  std::vector<uint8_t> hits(tree.numPoints(), 0);
+  const float *positions = tree.positions().data();
+  detail::parallelFor(pending.size(), detail::resolveThreadCount(threads),
+                      [&](size_t task) {
+                        const Range &range = pending[task];
+                        testPoints(positions + size_t(range.first) * 3,
+                                   range.count, &hits[range.first]);
+                      });
+  for (const Range &range : pending) {
+    for (uint32_t i = range.first; i < range.first + range.count; i++) {
+      if (hits[i])
+        setBit(order[i]);
+    }
+  }
+  return bits;
+}
+
+} // namespace pcd
@@ -0,0 +1,40 @@
+#ifndef PCD_TEMP_FILE_H
+#define PCD_TEMP_FILE_H
+
+// Temporary file naming and atomic replacement shared by the writers
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+namespace pcd {
+namespace detail {
+
+// Unique path derived from `base` (a sibling when base is a file path)
+inline std::string temporaryPathFor(const std::string &base) {
+  static std::atomic<unsigned> counter{0};
+  size_t thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return base + ".tmp" + std::to_string(thread % 100000) + "_" +
+         std::to_string(counter++);
+}
+
+// Atomically move `from` over `to` (the temp file is removed on failure)
+inline void replaceFile(const std::string &from, const std::string &to) {
+  std::error_code ec;
+  std::filesystem::rename(from, to, ec);
+  if (ec) {
+    std::remove(from.c_str());
+    throw std::runtime_error("Failed to replace file: " + to + " (" +
+                             ec.message() + ")");
+  }
+}
+
+} // namespace detail
+} // namespace pcd
+
+#endif // PCD_TEMP_FILE_H
@@ -0,0 +1,222 @@
+#ifndef PCD_TRANSPOSE_H
+#define PCD_TRANSPOSE_H
+
+// AoS <-> SoA kernels for fixed-size PCD point records.
+// Kernels are chosen once per field from its element type and the record
+// stride, so the per-point loops contain no type dispatch.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PCD_TRANSPOSE_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PCD_TRANSPOSE_NEON 1
+#endif
+
+namespace pcd {
+namespace detail {
+
+// Copy one field out of `count` interleaved records into a dense column
+using DeinterleaveFn = void (*)(const uint8_t *src, size_t stride,
+                                size_t count, void *dst);
+
+// Stride known at compile time: constant-offset loads the compiler can unroll
+template <typename T, size_t Stride>
+void deinterleaveFixed(const uint8_t *src, size_t /* stride */, size_t count,
+                       void *dst) {
+  T *out = static_cast<T *>(dst);
+  for (size_t i = 0; i < count; i++) {
+    std::memcpy(out + i, src + i * Stride, sizeof(T));
+  }
+}
+
+// Generic fallback for uncommon record sizes
+template <typename T>
+void deinterleaveStrided(const uint8_t *src, size_t stride, size_t count,
+                         void *dst) {
+  T *out = static_cast<T *>(dst);
+  for (size_t i = 0; i < count; i++) {
+    std::memcpy(out + i, src + i * stride, sizeof(T));
+  }
+}
+
+// Pick the kernel for an element type and record stride
+template <typename T> DeinterleaveFn selectDeinterleave(size_t stride) {
+  switch (stride) {
+  case 4:
+    return deinterleaveFixed<T, 4>;
+  case 8:
+    return deinterleaveFixed<T, 8>;
+  case 12: // x y z
+    return deinterleaveFixed<T, 12>;
+  case 16: // x y z intensity / x y z rgb
+    return deinterleaveFixed<T, 16>;
+  case 20: // x y z rgb label
+    return deinterleaveFixed<T, 20>;
+  case 24:
+    return deinterleaveFixed<T, 24>;
+  case 28:
+    return deinterleaveFixed<T, 28>;
+  case 32:
+    return deinterleaveFixed<T, 32>;
+  case 48:
+    return deinterleaveFixed<T, 48>;
+  default:
+    return deinterleaveStrided<T>;
+  }
+}
+
+// Split `count` 16-byte records made of four 4-byte fields into four columns.
+// Values are moved as raw 32-bit lanes, so float bit patterns (NaN payloads,
+// PCL packed rgb) are preserved.
+inline void deinterleave4x32(const uint8_t *src, size_t count, void *dst0,
+                             void *dst1, void *dst2, void *dst3) {
+  uint8_t *out[4] = {static_cast<uint8_t *>(dst0), static_cast<uint8_t *>(dst1),
+                     static_cast<uint8_t *>(dst2), static_cast<uint8_t *>(dst3)};
+  size_t i = 0;
+
+#if defined(PCD_TRANSPOSE_SSE2)
+  for (; i + 4 <= count; i += 4) {
+    const uint8_t *p = src + i * 16;
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 48));
+
+    // 4x4 transpose of 32-bit lanes
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1); // a0 b0 a1 b1
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3); // c0 d0 c1 d1
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1); // a2 b2 a3 b3
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3); // c2 d2 c3 d3
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[0] + i * 4),
+                     _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[1] + i * 4),
+                     _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[2] + i * 4),
+                     _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out[3] + i * 4),
+                     _mm_unpackhi_epi64(t2, t3));
+  }
+#elif defined(PCD_TRANSPOSE_NEON)
+  for (; i + 4 <= count; i += 4) {
+    uint32x4x4_t v = vld4q_u32(reinterpret_cast<const uint32_t *>(src + i * 16));
+    vst1q_u32(reinterpret_cast<uint32_t *>(out[0] + i * 4), v.val[0]);
+    vst1q_u32(reinterpret_cast<uint32_t *>(out[1] + i * 4), v.val[1]);
+    vst1q_u32(reinterpret_cast<uint32_t *>(out[2] + i * 4), v.val[2]);
+    vst1q_u32(reinterpret_cast<uint32_t *>(out[3] + i * 4), v.val[3]);
+  }
+#endif
+
+  for (; i < count; i++) {
+    for (int f = 0; f < 4; f++) {
+      std::memcpy(out[f] + i * 4, src + i * 16 + f * 4, 4);
+    }
+  }
+}
+
+// Scatter a dense column into one field of `count` interleaved records
+using InterleaveFn = void (*)(const void *src, size_t count, uint8_t *dst,
+                              size_t stride);
+
+template <typename T, size_t Stride>
+void interleaveFixed(const void *src, size_t count, uint8_t *dst,
+                     size_t /* stride */) {
+  const T *in = static_cast<const T *>(src);
+  for (size_t i = 0; i < count; i++) {
+    std::memcpy(dst + i * Stride, in + i, sizeof(T));
+  }
+}
+
+template <typename T>
+void interleaveStrided(const void *src, size_t count, uint8_t *dst,
+                       size_t stride) {
+  const T *in = static_cast<const T *>(src);
+  for (size_t i = 0; i < count; i++) {
+    std::memcpy(dst + i * stride, in + i, sizeof(T));
+  }
+}
+
+template <typename T> InterleaveFn selectInterleave(size_t stride) {
+  switch (stride) {
+  case 4:
+    return interleaveFixed<T, 4>;
+  case 8:
+    return interleaveFixed<T, 8>;
+  case 12:
+    return interleaveFixed<T, 12>;
+  case 16:
+    return interleaveFixed<T, 16>;
+  case 20:
+    return interleaveFixed<T, 20>;
+  case 24:
+    return interleaveFixed<T, 24>;
+  case 28:
+    return interleaveFixed<T, 28>;
+  case 32:
+    return interleaveFixed<T, 32>;
+  case 48:
+    return interleaveFixed<T, 48>;
+  default:
+    return interleaveStrided<T>;
+  }
+}
+
+// Inverse of deinterleave4x32: merge four 4-byte columns into 16-byte records
+inline void interleave4x32(const void *src0, const void *src1,
+                           const void *src2, const void *src3, size_t count,
+                           uint8_t *dst) {
+  const uint8_t *in[4] = {static_cast<const uint8_t *>(src0),
+                          static_cast<const uint8_t *>(src1),
+                          static_cast<const uint8_t *>(src2),
+                          static_cast<const uint8_t *>(src3)};
+  size_t i = 0;
+
+#if defined(PCD_TRANSPOSE_SSE2)
+  for (; i + 4 <= count; i += 4) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[0] + i * 4));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[1] + i * 4));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[2] + i * 4));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[3] + i * 4));
+
+    __m128i t0 = _mm_unpacklo_epi32(a, b); // a0 b0 a1 b1
+    __m128i t1 = _mm_unpacklo_epi32(c, d); // c0 d0 c1 d1
+    __m128i t2 = _mm_unpackhi_epi32(a, b); // a2 b2 a3 b3
+    __m128i t3 = _mm_unpackhi_epi32(c, d); // c2 d2 c3 d3
+
+    uint8_t *p = dst + i * 16;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p),
+                     _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 16),
+                     _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 32),
+                     _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 48),
+                     _mm_unpackhi_epi64(t2, t3));
+  }
+#elif defined(PCD_TRANSPOSE_NEON)
+  for (; i + 4 <= count; i += 4) {
+    uint32x4x4_t v;
+    v.val[0] = vld1q_u32(reinterpret_cast<const uint32_t *>(in[0] + i * 4));
+    v.val[1] = vld1q_u32(reinterpret_cast<const uint32_t *>(in[1] + i * 4));
+    v.val[2] = vld1q_u32(reinterpret_cast<const uint32_t *>(in[2] + i * 4));
+    v.val[3] = vld1q_u32(reinterpret_cast<const uint32_t *>(in[3] + i * 4));
+    vst4q_u32(reinterpret_cast<uint32_t *>(dst + i * 16), v);
+  }
+#endif
+
+  for (; i < count; i++) {
+    for (int f = 0; f < 4; f++) {
+      std::memcpy(dst + i * 16 + f * 4, in[f] + i * 4, 4);
+    }
+  }
+}
+
+} // namespace detail
+} // namespace pcd
+
+#endif // PCD_TRANSPOSE_H
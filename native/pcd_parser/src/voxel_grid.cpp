@@ -0,0 +1,261 @@
+#include "pcd_parser/pcd_parser.h"
+#include "parallel.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace pcd {
+
+// Points per parallel task when computing bounds and voxel keys
+static constexpr size_t kVoxelChunk = 1 << 16;
+// Hash buckets grouped independently. Fixed, so the result does not depend
+// on the thread count.
+static constexpr size_t kVoxelBuckets = 256;
+static constexpr uint64_t kCellsPerAxis = 1u << 21;
+static constexpr uint64_t kNoKey = std::numeric_limits<uint64_t>::max();
+
+static size_t bucketOf(uint64_t key) {
+  return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 56);
+}
+
+VoxelGrid PCDParser::voxelGrid(const PCDData &data, double leafSize,
+                               unsigned threads) {
+  const PCDHeader &header = data.header;
+  int axes[3] = {header.findField("x"), header.findField("y"),
+                 header.findField("z")};
+  if (axes[0] < 0 || axes[1] < 0 || axes[2] < 0) {
+    throw std::runtime_error("Voxel grid requires x, y and z fields");
+  }
+  if (!(leafSize > 0) || !std::isfinite(leafSize)) {
+    throw std::runtime_error("Voxel size must be positive");
+  }
+
+  size_t n = data.numPoints();
+  if (n > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Voxel grid is limited to 2^32 points");
+  }
+  // Float columns are used in place, others converted
+  std::vector<float> converted[3];
+  const float *columns[3];
+  for (int a = 0; a < 3; a++) {
+    const FieldData &column = data.fieldData[axes[a]];
+    if (auto floats = std::get_if<std::vector<float>>(&column)) {
+      columns[a] = floats->data();
+      if (floats->size() != n)
+        throw std::runtime_error("Voxel grid requires decoded x, y and z");
+      continue;
+    }
+    converted[a] = std::visit(
+        [](const auto &vec) {
+          return std::vector<float>(vec.begin(), vec.end());
+        },
+        column);
+    if (converted[a].size() != n)
+      throw std::runtime_error("Voxel grid requires decoded x, y and z");
+    columns[a] = converted[a].data();
+  }
+  const float *x = columns[0], *y = columns[1], *z = columns[2];
+  threads = detail::resolveThreadCount(threads);
+  size_t tasks = (n + kVoxelChunk - 1) / kVoxelChunk;
+
+  VoxelGrid grid;
+  grid.voxelOf.assign(n, VoxelGrid::kNoVoxel);
+
+  // Grid origin: the minimum corner of the finite points
+  std::vector<std::array<float, 3>> partial(tasks,
+                                            {INFINITY, INFINITY, INFINITY});
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    auto &lo = partial[t];
+    size_t last = std::min(n, (t + 1) * kVoxelChunk);
+    for (size_t i = t * kVoxelChunk; i < last; i++) {
+      if (!std::isfinite(x[i]) || !std::isfinite(y[i]) || !std::isfinite(z[i]))
+        continue;
+      lo[0] = std::min(lo[0], x[i]);
+      lo[1] = std::min(lo[1], y[i]);
+      lo[2] = std::min(lo[2], z[i]);
+    }
+  });
+  double origin[3] = {INFINITY, INFINITY, INFINITY};
+  for (const auto &lo : partial) {
+    for (int a = 0; a < 3; a++)
+      origin[a] = std::min(origin[a], double(lo[a]));
+  }
+  if (!std::isfinite(origin[0]))
+    return grid; // No finite points
+
+  // Voxel key of every point, and how many points each task puts in each
+  // bucket
+  std::vector<uint64_t> keys(n);
+  std::vector<size_t> bucketCounts(tasks * kVoxelBuckets, 0);
+  std::atomic<bool> tooFine{false};
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t *counts = &bucketCounts[t * kVoxelBuckets];
+    size_t last = std::min(n, (t + 1) * kVoxelChunk);
+    for (size_t i = t * kVoxelChunk; i < last; i++) {
+      if (!std::isfinite(x[i]) || !std::isfinite(y[i]) ||
+          !std::isfinite(z[i])) {
+        keys[i] = kNoKey;
+        continue;
+      }
+      double cell[3] = {(x[i] - origin[0]) / leafSize,
+                        (y[i] - origin[1]) / leafSize,
+                        (z[i] - origin[2]) / leafSize};
+      uint64_t key = 0;
+      for (int a = 0; a < 3; a++) {
+        if (cell[a] >= double(kCellsPerAxis)) {
+          tooFine = true;
+          cell[a] = 0;
+        }
+        key |= static_cast<uint64_t>(cell[a]) << (21 * a);
+      }
+      keys[i] = key;
+      counts[bucketOf(key)]++;
+    }
+  });
+  if (tooFine) {
+    throw std::runtime_error("Voxel size too small for the cloud's extent");
+  }
+
+  // Scatter point indices bucket by bucket, keeping ascending order within
+  // each bucket
+  std::vector<size_t> bucketStart(kVoxelBuckets + 1, 0);
+  std::vector<size_t> cursor(tasks * kVoxelBuckets);
+  for (size_t b = 0; b < kVoxelBuckets; b++) {
+    size_t at = bucketStart[b];
+    for (size_t t = 0; t < tasks; t++) {
+      cursor[t * kVoxelBuckets + b] = at;
+      at += bucketCounts[t * kVoxelBuckets + b];
+    }
+    bucketStart[b + 1] = at;
+  }
+  std::vector<uint32_t> members(bucketStart[kVoxelBuckets]);
+  detail::parallelFor(tasks, threads, [&](size_t t) {
+    size_t *next = &cursor[t * kVoxelBuckets];
+    size_t last = std::min(n, (t + 1) * kVoxelChunk);
+    for (size_t i = t * kVoxelChunk; i < last; i++) {
+      if (keys[i] != kNoKey)
+        members[next[bucketOf(keys[i])]++] = static_cast<uint32_t>(i);
+    }
+  });
+
+  // Group each bucket by key. voxelOf temporarily holds bucket-local voxel
+  // ids; the representative is the point nearest the voxel's center, the
+  // lowest index on ties.
+  std::vector<std::vector<uint32_t>> bucketReps(kVoxelBuckets);
+  detail::parallelFor(kVoxelBuckets, threads, [&](size_t b) {
+    std::unordered_map<uint64_t, uint32_t> local;
+    std::vector<double> bestDistance;
+    auto &reps = bucketReps[b];
+    for (size_t m = bucketStart[b]; m < bucketStart[b + 1]; m++) {
+      uint32_t i = members[m];
+      uint64_t key = keys[i];
+      auto inserted = local.emplace(key, static_cast<uint32_t>(reps.size()));
+      uint32_t voxel = inserted.first->second;
+      double distance = 0;
+      for (int a = 0; a < 3; a++) {
+        uint64_t cell = (key >> (21 * a)) & (kCellsPerAxis - 1);
+        double center = origin[a] + (double(cell) + 0.5) * leafSize;
+        double d = double(columns[a][i]) - center;
+        distance += d * d;
+      }
+      if (inserted.second) {
+        reps.push_back(i);
+        bestDistance.push_back(distance);
+      } else if (distance < bestDistance[voxel]) {
+        reps[voxel] = i;
+        bestDistance[voxel] = distance;
+      }
+      grid.voxelOf[i] = voxel;
+    }
+  });
+
+  // Number voxels by their representative's index
+  // (representative, bucket) pairs
+  std::vector<std::pair<uint32_t, uint32_t>> ranked;
+  for (size_t b = 0; b < kVoxelBuckets; b++) {
+    for (uint32_t rep : bucketReps[b])
+      ranked.push_back({rep, static_cast<uint32_t>(b)});
+  }
+  std::sort(ranked.begin(), ranked.end());
+  grid.representatives.resize(ranked.size());
+  for (size_t v = 0; v < ranked.size(); v++) {
+    grid.representatives[v] = ranked[v].first;
+    // Reuse the bucket's representative list as its local-to-global map
+    uint32_t rep = ranked[v].first;
+    uint32_t localId = grid.voxelOf[rep];
+    bucketReps[ranked[v].second][localId] = static_cast<uint32_t>(v);
+  }
+  detail::parallelFor(kVoxelBuckets, threads, [&](size_t b) {
+    const auto &toGlobal = bucketReps[b];
+    for (size_t m = bucketStart[b]; m < bucketStart[b + 1]; m++) {
+      uint32_t i = members[m];
+      grid.voxelOf[i] = toGlobal[grid.voxelOf[i]];
+    }
+  });
+  return grid;
+}
+
+std::vector<LabelRun>
+VoxelGrid::expand(const std::vector<LabelRun> &voxelRuns) const {
+  std::vector<uint32_t> labels(representatives.size());
+  std::vector<bool> assigned(representatives.size(), false);
+  for (const auto &run : voxelRuns) {
+    if (run.start > representatives.size() ||
+        run.count > representatives.size() - run.start) {
+      throw std::runtime_error("Label run extends past the last voxel");
+    }
+    for (uint32_t v = run.start; v < run.start + run.count; v++) {
+      labels[v] = run.label;
+      assigned[v] = true;
+    }
+  }
+
+  std::vector<LabelRun> runs;
+  for (size_t i = 0; i < voxelOf.size(); i++) {
+    uint32_t voxel = voxelOf[i];
+    if (voxel == kNoVoxel || !assigned[voxel])
+      continue;
+    uint32_t label = labels[voxel];
+    if (!runs.empty() && runs.back().label == label &&
+        size_t(runs.back().start) + runs.back().count == i) {
+      runs.back().count++;
+    } else {
+      runs.push_back({static_cast<uint32_t>(i), 1, label});
+    }
+  }
+  return runs;
+}
+
+PCDData PCDParser::subset(const PCDData &data,
+                          const std::vector<uint32_t> &indices) {
+  PCDData result;
+  result.header = data.header;
+  result.header.width = static_cast<int>(indices.size());
+  result.header.height = 1;
+  result.header.points = static_cast<int>(indices.size());
+  result.fieldData.reserve(data.fieldData.size());
+  for (const auto &column : data.fieldData) {
+    result.fieldData.push_back(std::visit(
+        [&](const auto &vec) -> FieldData {
+          using T = typename std::decay_t<decltype(vec)>::value_type;
+          std::vector<T> picked;
+          if (vec.empty())
+            return picked;
+          picked.reserve(indices.size());
+          for (uint32_t i : indices) {
+            if (i >= vec.size())
+              throw std::runtime_error("Subset index out of range");
+            picked.push_back(vec[i]);
+          }
+          return picked;
+        },
+        column));
+  }
+  return result;
+}
+
+} // namespace pcd
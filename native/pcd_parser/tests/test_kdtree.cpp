@@ -0,0 +1,131 @@
+#include "pcd_parser/kdtree.h"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+struct Cloud {
+  std::vector<float> x, y, z;
+};
+
+Cloud randomCloud(size_t n) {
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> spread(-50.0f, 50.0f);
+  Cloud cloud;
+  for (size_t i = 0; i < n; i++) {
+    cloud.x.push_back(spread(rng));
+    cloud.y.push_back(spread(rng));
+    cloud.z.push_back(spread(rng) * 0.1f);
+  }
+  cloud.z[11] = NAN; // Never a neighbour
+  return cloud;
+}
+
+float distanceSq(const Cloud &cloud, size_t i, const float *p) {
+  float dx = cloud.x[i] - p[0], dy = cloud.y[i] - p[1], dz = cloud.z[i] - p[2];
+  return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+TEST(KdTree, MatchesBruteForce) {
+  const size_t n = 20000;
+  Cloud cloud = randomCloud(n);
+  pcd::KdTreeOptions options;
+  options.threads = 4;
+  pcd::KdTree tree = pcd::KdTree::build(cloud.x.data(), cloud.y.data(),
+                                        cloud.z.data(), n, options);
+  ASSERT_EQ(tree.numPoints(), n - 1);
+
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<float> spread(-60.0f, 60.0f);
+  std::vector<uint32_t> found;
+  std::vector<float> distances;
+  for (int q = 0; q < 50; q++) {
+    float p[3] = {spread(rng), spread(rng), spread(rng) * 0.1f};
+
+    tree.knn(p, 10, found, &distances);
+    ASSERT_EQ(found.size(), 10u);
+    std::vector<float> expected;
+    for (size_t i = 0; i < n; i++) {
+      if (i != 11)
+        expected.push_back(distanceSq(cloud, i, p));
+    }
+    std::sort(expected.begin(), expected.end());
+    for (size_t j = 0; j < found.size(); j++) {
+      EXPECT_FLOAT_EQ(distances[j], expected[j]);
+      EXPECT_FLOAT_EQ(distanceSq(cloud, found[j], p), expected[j]);
+    }
+
+    found.clear();
+    tree.radius(p, 4.0f, found);
+    std::sort(found.begin(), found.end());
+    std::vector<uint32_t> inside;
+    for (size_t i = 0; i < n; i++) {
+      if (i != 11 && distanceSq(cloud, i, p) <= 16.0f)
+        inside.push_back(static_cast<uint32_t>(i));
+    }
+    EXPECT_EQ(found, inside);
+  }
+
+  // Fewer points than k
+  pcd::KdTree small = pcd::KdTree::build(cloud.x.data(), cloud.y.data(),
+                                         cloud.z.data(), 5);
+  float origin[3] = {0, 0, 0};
+  small.knn(origin, 10, found);
+  EXPECT_EQ(found.size(), 5u);
+}
+
+TEST(KdTree, SmoothLabels) {
+  // Two classes split at x = 0 on a regular grid, with isolated speckles
+  std::vector<float> x, y, z;
+  std::vector<uint32_t> labels;
+  for (int i = 0; i < 100; i++) {
+    for (int j = 0; j < 100; j++) {
+      x.push_back(static_cast<float>(i));
+      y.push_back(static_cast<float>(j));
+      z.push_back(0);
+      labels.push_back(i < 50 ? 1 : 2);
+    }
+  }
+  const size_t n = labels.size();
+  std::vector<uint32_t> noisy = labels;
+  std::vector<size_t> speckles = {10 * 100 + 10, 70 * 100 + 30, 25 * 100 + 80};
+  for (size_t s : speckles)
+    noisy[s] = 3;
+  noisy[40 * 100 + 40] = 0;
+
+  pcd::KdTree tree = pcd::KdTree::build(x.data(), y.data(), z.data(), n);
+  pcd::SmoothOptions options;
+  options.k = 9;
+  options.threads = 4;
+  EXPECT_EQ(pcd::smoothLabels(tree, noisy, {}, options), labels);
+
+  // Only masked points change
+  std::vector<uint8_t> mask((n + 7) / 8, 0);
+  size_t masked = speckles[0];
+  mask[masked >> 3] |= 1 << (masked & 7);
+  std::vector<uint32_t> expected = noisy;
+  expected[masked] = labels[masked];
+  EXPECT_EQ(pcd::smoothLabels(tree, noisy, mask, options), expected);
+
+  // A block of unlabeled points fills in from its labeled surroundings only
+  // when unlabeled neighbours do not vote
+  std::vector<uint32_t> holes = labels;
+  for (int i = 20; i < 23; i++) {
+    for (int j = 20; j < 23; j++)
+      holes[i * 100 + j] = 0;
+  }
+  options.radius = 1.5f;
+  EXPECT_EQ(pcd::smoothLabels(tree, holes, {}, options)[21 * 100 + 21], 0u);
+  options.ignoreUnlabeled = true;
+  options.iterations = 3;
+  EXPECT_EQ(pcd::smoothLabels(tree, holes, {}, options), labels);
+
+  EXPECT_THROW(pcd::smoothLabels(tree, std::vector<uint32_t>(10), {}),
+               std::runtime_error);
+  EXPECT_THROW(pcd::smoothLabels(tree, labels, std::vector<uint8_t>(3)),
+               std::runtime_error);
+}
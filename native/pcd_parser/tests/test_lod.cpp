@@ -0,0 +1,130 @@
+#include "pcd_parser/lod.h"
+#include <array>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+pcd::Octree randomTree(size_t n) {
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> spread(-100.0f, 100.0f);
+  std::vector<float> x(n), y(n), z(n);
+  for (size_t i = 0; i < n; i++) {
+    x[i] = spread(rng);
+    y[i] = spread(rng);
+    z[i] = spread(rng) * 0.05f;
+  }
+  x[7] = NAN; // Not in the octree, so not in the hierarchy either
+  return pcd::Octree::build(x.data(), y.data(), z.data(), n);
+}
+
+// Perspective camera at (0, 0, eyeZ) looking down -z
+std::array<float, 16> cameraMatrix(float eyeZ) {
+  const float f = 1.0f / std::tan(30.0f * 3.14159265f / 180.0f);
+  const float near = 0.1f, far = 10000.0f;
+  float a = (far + near) / (near - far), b = 2 * far * near / (near - far);
+  std::array<float, 16> m{};
+  m[0] = f;
+  m[5] = f;
+  m[10] = a;
+  m[11] = -1;
+  m[14] = -a * eyeZ + b;
+  m[15] = eyeZ;
+  return m;
+}
+
+} // namespace
+
+// Test that every octree point lands in exactly one node
+TEST(LodHierarchy, PartitionsPoints) {
+  const size_t n = 100000;
+  pcd::Octree tree = randomTree(n);
+  pcd::LodOptions options;
+  options.nodePoints = 1000;
+  options.threads = 4;
+  pcd::LodHierarchy lod = pcd::LodHierarchy::build(tree, options);
+
+  ASSERT_EQ(lod.numPoints(), tree.numPoints());
+  ASSERT_EQ(lod.positions().size(), lod.numPoints() * 3);
+  std::vector<int> seen(n, 0);
+  for (uint32_t index : lod.indices())
+    seen[index]++;
+  for (size_t i = 0; i < n; i++)
+    EXPECT_EQ(seen[i], i == 7 ? 0 : 1) << i;
+
+  const auto &nodes = lod.nodes();
+  ASSERT_GT(nodes.size(), 8u);
+  EXPECT_EQ(nodes[0].count, 1000u);
+  size_t covered = 0;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const pcd::LodNode &node = nodes[i];
+    covered += node.count;
+    EXPECT_LE(node.count, options.nodePoints);
+    EXPECT_EQ(node.childCount == 0, node.spacing == 0) << i;
+    for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount;
+         c++) {
+      ASSERT_GT(c, i);
+      EXPECT_EQ(nodes[c].level, node.level + 1);
+      EXPECT_LT(nodes[c].spacing, node.spacing);
+    }
+    // Points lie inside their node's bounds
+    for (uint32_t p = node.first; p < node.first + node.count; p++) {
+      for (int a = 0; a < 3; a++) {
+        float v = lod.positions()[size_t(p) * 3 + a];
+        EXPECT_GE(v, node.min[a]);
+        EXPECT_LE(v, node.max[a]);
+      }
+    }
+  }
+  EXPECT_EQ(covered, lod.numPoints());
+}
+
+TEST(LodHierarchy, SelectByDistanceAndFrustum) {
+  pcd::Octree tree = randomTree(100000);
+  pcd::LodOptions options;
+  options.nodePoints = 1000;
+  pcd::LodHierarchy lod = pcd::LodHierarchy::build(tree, options);
+  const auto &nodes = lod.nodes();
+
+  auto countPoints = [&](const std::vector<uint32_t> &ids) {
+    size_t points = 0;
+    for (uint32_t id : ids)
+      points += nodes[id].count;
+    return points;
+  };
+
+  // Far away the root alone is detailed enough
+  auto far = cameraMatrix(5000.0f);
+  EXPECT_EQ(lod.select(far.data(), 800), std::vector<uint32_t>{0});
+
+  // Close up, refinement goes deeper; parents always come first
+  auto near = cameraMatrix(150.0f);
+  std::vector<uint32_t> selected = lod.select(near.data(), 800);
+  EXPECT_GT(selected.size(), 1u);
+  std::vector<bool> included(nodes.size(), false);
+  for (uint32_t id : selected) {
+    included[id] = true;
+    for (uint32_t c = nodes[id].firstChild;
+         c < nodes[id].firstChild + nodes[id].childCount; c++)
+      EXPECT_FALSE(included[c]);
+  }
+
+  // The point budget caps the selection
+  pcd::LodQuery query;
+  query.errorPixels = 0;
+  query.pointBudget = 5000;
+  EXPECT_LE(countPoints(lod.select(near.data(), 800, query)), 5000u);
+  query.pointBudget = 1000000;
+  EXPECT_EQ(countPoints(lod.select(near.data(), 800, query)),
+            lod.numPoints());
+
+  // Turned around to look down +z, the cloud is behind the camera
+  auto away = near;
+  away[0] = -near[0];
+  away[10] = -near[10];
+  away[11] = 1;
+  away[14] = near[14] + 300.0f * near[10];
+  away[15] = -150.0f;
+  EXPECT_TRUE(lod.select(away.data(), 800).empty());
+}
@@ -0,0 +1,130 @@
+#include "pcd_parser/octree.h"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+
+namespace {
+
+struct Cloud {
+  std::vector<float> x, y, z;
+};
+
+Cloud randomCloud(size_t n) {
+  std::mt19937 rng(7);
+  std::normal_distribution<float> spread(0.0f, 10.0f);
+  Cloud cloud;
+  for (size_t i = 0; i < n; i++) {
+    cloud.x.push_back(spread(rng));
+    cloud.y.push_back(spread(rng) * 0.5f);
+    cloud.z.push_back(i % 10 == 0 ? 2.0f : spread(rng) * 0.1f); // Some duplicates
+  }
+  cloud.x[3] = NAN; // Left out of the tree
+  return cloud;
+}
+
+std::vector<uint32_t> sorted(std::vector<uint32_t> values) {
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+} // namespace
+
+// Test structure invariants and queries against brute force
+TEST(Octree, QueriesMatchBruteForce) {
+  const size_t n = 200000;
+  Cloud cloud = randomCloud(n);
+  pcd::OctreeOptions options;
+  options.leafSize = 32;
+  options.threads = 4;
+  pcd::Octree tree =
+      pcd::Octree::build(cloud.x.data(), cloud.y.data(), cloud.z.data(), n,
+                         options);
+  ASSERT_EQ(tree.numPoints(), n - 1);
+  EXPECT_GT(tree.depth(), 2u);
+
+  // Children partition their parent's range; leaves respect the leaf size
+  const auto &nodes = tree.nodes();
+  EXPECT_EQ(nodes[0].count, n - 1);
+  for (const auto &node : nodes) {
+    if (node.childCount == 0) {
+      EXPECT_TRUE(node.count <= 32 || node.level == pcd::Octree::kMaxLevel);
+      continue;
+    }
+    uint32_t next = node.first;
+    for (uint32_t c = 0; c < node.childCount; c++) {
+      EXPECT_EQ(nodes[node.firstChild + c].first, next);
+      next += nodes[node.firstChild + c].count;
+    }
+    EXPECT_EQ(next, node.first + node.count);
+  }
+
+  float min[3] = {-5.0f, -2.0f, -0.5f}, max[3] = {8.0f, 3.0f, 2.0f};
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < n; i++) {
+    if (cloud.x[i] >= min[0] && cloud.x[i] <= max[0] && cloud.y[i] >= min[1] &&
+        cloud.y[i] <= max[1] && cloud.z[i] >= min[2] && cloud.z[i] <= max[2])
+      expected.push_back(i);
+  }
+  std::vector<uint32_t> found;
+  tree.queryBox(min, max, found);
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(sorted(found), expected);
+
+  float center[3] = {1.0f, 1.0f, 0.0f};
+  float radius = 4.0f;
+  expected.clear();
+  for (uint32_t i = 0; i < n; i++) {
+    float dx = cloud.x[i] - center[0], dy = cloud.y[i] - center[1],
+          dz = cloud.z[i] - center[2];
+    if (dx * dx + dy * dy + dz * dz <= radius * radius)
+      expected.push_back(i);
+  }
+  found.clear();
+  tree.queryRadius(center, radius, found);
+  EXPECT_EQ(sorted(found), expected);
+
+  // The parallel build is deterministic
+  options.threads = 1;
+  pcd::Octree serial =
+      pcd::Octree::build(cloud.x.data(), cloud.y.data(), cloud.z.data(), n,
+                         options);
+  EXPECT_EQ(serial.order(), tree.order());
+  EXPECT_EQ(serial.nodes().size(), tree.nodes().size());
+}
+
+// Test serialization and building from cloud columns
+TEST(Octree, SaveLoadAndCloudColumns) {
+  const size_t n = 5000;
+  Cloud cloud = randomCloud(n);
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("y", 8, 'F', 1);
+  data.header.addField("z", 4, 'F', 1);
+  data.fieldData.push_back(cloud.x);
+  data.fieldData.push_back(std::vector<double>(cloud.y.begin(), cloud.y.end()));
+  data.fieldData.push_back(cloud.z);
+  pcd::Octree tree = pcd::Octree::build(data);
+
+  std::stringstream stream;
+  tree.save(stream);
+  pcd::Octree loaded = pcd::Octree::load(stream);
+  EXPECT_EQ(loaded.order(), tree.order());
+  EXPECT_EQ(loaded.positions(), tree.positions());
+  EXPECT_EQ(loaded.leafSize(), tree.leafSize());
+
+  float center[3] = {0.0f, 0.0f, 0.0f};
+  std::vector<uint32_t> a, b;
+  tree.queryRadius(center, 6.0f, a);
+  loaded.queryRadius(center, 6.0f, b);
+  EXPECT_EQ(a, b);
+
+  std::stringstream garbage("not an octree");
+  EXPECT_THROW(pcd::Octree::load(garbage), std::runtime_error);
+
+  pcd::PCDData noZ;
+  noZ.header.addField("x", 4, 'F', 1);
+  noZ.fieldData.push_back(cloud.x);
+  EXPECT_THROW(pcd::Octree::build(noZ), std::runtime_error);
+}
@@ -0,0 +1,133 @@
+#include "pcd_parser/pcd_cache.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string writeCloud(const std::string &name, size_t n) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("intensity", 4, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+  std::vector<float> xs(n), intensity(n);
+  std::vector<uint32_t> labels(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i);
+    intensity[i] = static_cast<float>(i) * 0.5f;
+    labels[i] = static_cast<uint32_t>(i % 3);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(intensity);
+  data.fieldData.push_back(labels);
+
+  std::string path = testing::TempDir() + name;
+  pcd::PCDParser::write(path, data, std::string("binary"));
+  return path;
+}
+
+} // namespace
+
+// Test hits, and that a rewritten file is decoded again
+TEST(PCDCache, HitsAndRevalidation) {
+  std::string path = writeCloud("cache_hits.pcd", 100);
+  pcd::PCDCache cache(64 << 20);
+
+  auto first = cache.get(path);
+  auto second = cache.get(path);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(cache.stats().hits, 1u);
+  EXPECT_EQ(cache.stats().misses, 1u);
+
+  writeCloud("cache_hits.pcd", 120);
+  auto third = cache.get(path);
+  EXPECT_NE(third, first);
+  EXPECT_EQ(third->numPoints(), 120u);
+  EXPECT_EQ(first->numPoints(), 100u); // Old data stays valid
+
+  cache.invalidate(path);
+  EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+// Test that field subsets are decoded incrementally into one entry
+TEST(PCDCache, IncrementalFields) {
+  std::string path = writeCloud("cache_fields.pcd", 50);
+  pcd::PCDCache cache(64 << 20);
+
+  pcd::ParseOptions positions;
+  positions.fields = {"x", "label"};
+  auto partial = cache.get(path, positions);
+  EXPECT_TRUE(std::get<std::vector<float>>(partial->fieldData[1]).empty());
+
+  pcd::ParseOptions intensity;
+  intensity.fields = {"intensity"};
+  auto merged = cache.get(path, intensity);
+  EXPECT_EQ(std::get<std::vector<float>>(merged->fieldData[0]).size(), 50u);
+  EXPECT_EQ(std::get<std::vector<float>>(merged->fieldData[1]).size(), 50u);
+  EXPECT_EQ(merged->getLabels().size(), 50u);
+
+  // Everything is decoded now, so the full request is a hit
+  EXPECT_EQ(cache.get(path), merged);
+  EXPECT_EQ(cache.stats().entries, 1u);
+}
+
+// Test byte-budget eviction in least recently used order
+TEST(PCDCache, EvictsLeastRecentlyUsed) {
+  std::string a = writeCloud("cache_a.pcd", 1000);
+  std::string b = writeCloud("cache_b.pcd", 1000);
+  std::string c = writeCloud("cache_c.pcd", 1000);
+  pcd::PCDCache cache(40000); // Room for two ~16 KB entries
+
+  auto first = cache.get(a);
+  cache.get(b);
+  cache.get(a); // a is now most recent
+  cache.get(c); // evicts b
+  EXPECT_EQ(cache.stats().entries, 2u);
+  EXPECT_EQ(cache.get(a), first);
+
+  uint64_t misses = cache.stats().misses;
+  cache.get(b);
+  EXPECT_EQ(cache.stats().misses, misses + 1);
+  EXPECT_LE(cache.stats().bytes, 40000u);
+
+  cache.setBudget(0);
+  EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+// Test that octrees are kept with their entry and persisted across caches
+TEST(PCDCache, Octree) {
+  std::string path = writeCloud("cache_octree.pcd", 300);
+  std::string directory = testing::TempDir() + "octree_cache";
+  std::filesystem::remove_all(directory);
+
+  pcd::PCDCache cache(64 << 20);
+  cache.setOctreeDirectory(directory);
+  EXPECT_THROW(cache.octree(path), std::runtime_error); // No y/z fields
+
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("y", 4, 'F', 1);
+  data.header.addField("z", 4, 'F', 1);
+  std::vector<float> xs(300), ys(300), zs(300);
+  for (size_t i = 0; i < 300; i++) {
+    xs[i] = static_cast<float>(i % 17);
+    ys[i] = static_cast<float>(i % 5);
+    zs[i] = static_cast<float>(i) * 0.01f;
+  }
+  data.fieldData = {xs, ys, zs};
+  pcd::PCDParser::write(path, data, std::string("binary"));
+
+  auto tree = cache.octree(path);
+  EXPECT_EQ(tree->numPoints(), 300u);
+  EXPECT_EQ(cache.octree(path), tree);
+  EXPECT_GT(cache.stats().bytes, tree->bytes());
+
+  // A new cache reloads the persisted tree instead of building it
+  pcd::PCDCache other(64 << 20);
+  other.setOctreeDirectory(directory);
+  auto reloaded = other.octree(path);
+  EXPECT_NE(reloaded, tree);
+  EXPECT_EQ(reloaded->order(), tree->order());
+  EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory),
+                          std::filesystem::directory_iterator()),
+            1);
+}
@@ -1,6 +1,9 @@
 #include "pcd_parser/pcd_parser.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <gtest/gtest.h>
 
 // Test that PCDHeader calculates point size correctly
@@ -110,6 +113,472 @@ TEST(PCDData, NumPoints) {
   EXPECT_EQ(data.numPoints(), 5);
 }
 
+// Test binary round trip through the memory-mapped parse path
+TEST(PCDParser, BinaryRoundTrip) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("intensity", 2, 'U', 1);
+  data.header.addField("t", 8, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+
+  const size_t n = 40000; // Spans several de-interleave blocks
+  std::vector<float> xs(n);
+  std::vector<uint16_t> intensity(n);
+  std::vector<double> ts(n);
+  std::vector<uint32_t> labels(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i) * 0.5f;
+    intensity[i] = static_cast<uint16_t>(i * 3);
+    ts[i] = 1.7e9 + static_cast<double>(i) * 1e-6;
+    labels[i] = static_cast<uint32_t>(i % 9);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(intensity);
+  data.fieldData.push_back(ts);
+  data.fieldData.push_back(labels);
+
+  std::string path = testing::TempDir() + "binary_roundtrip.pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+
+  ASSERT_EQ(parsed.numPoints(), n);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs);
+  EXPECT_EQ(std::get<std::vector<uint16_t>>(parsed.fieldData[1]), intensity);
+  EXPECT_EQ(std::get<std::vector<double>>(parsed.fieldData[2]), ts);
+  EXPECT_EQ(parsed.getLabels(), labels);
+}
+
+// Test that a truncated binary file yields only the complete records
+TEST(PCDParser, BinaryTruncated) {
+  std::string path = testing::TempDir() + "binary_truncated.pcd";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "VERSION 0.7\nFIELDS x y\nSIZE 4 4\nTYPE F F\nCOUNT 1 1\n"
+         << "WIDTH 3\nHEIGHT 1\nPOINTS 3\nDATA binary\n";
+    float values[5] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+    file.write(reinterpret_cast<const char *>(values), sizeof(values));
+  }
+
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+  ASSERT_EQ(parsed.numPoints(), 2);
+  EXPECT_FLOAT_EQ(std::get<std::vector<float>>(parsed.fieldData[1])[1], 4.0f);
+}
+
+// Test the four-lane transpose used for 16-byte x y z rgb records
+TEST(PCDParser, BinaryFourLaneRecords) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("y", 4, 'F', 1);
+  data.header.addField("z", 4, 'F', 1);
+  data.header.addField("rgb", 4, 'U', 1);
+
+  const size_t n = 4 * 16384 + 7; // Full blocks plus a scalar tail
+  std::vector<float> xs(n), ys(n), zs(n);
+  std::vector<uint32_t> rgb(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i);
+    ys[i] = -static_cast<float>(i);
+    zs[i] = i % 5 == 0 ? std::nanf("") : 0.25f * i;
+    rgb[i] = static_cast<uint32_t>(i * 2654435761u);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(ys);
+  data.fieldData.push_back(zs);
+  data.fieldData.push_back(rgb);
+
+  std::string path = testing::TempDir() + "binary_four_lane.pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+
+  ASSERT_EQ(parsed.numPoints(), n);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[1]), ys);
+  const auto &parsedZ = std::get<std::vector<float>>(parsed.fieldData[2]);
+  EXPECT_EQ(std::memcmp(parsedZ.data(), zs.data(), n * sizeof(float)), 0);
+  EXPECT_EQ(std::get<std::vector<uint32_t>>(parsed.fieldData[3]), rgb);
+}
+
+// Test that chunked multi-threaded ascii parsing matches a single thread
+TEST(PCDParser, AsciiParallelChunks) {
+  std::string path = testing::TempDir() + "ascii_chunks.pcd";
+  const size_t n = 5000;
+  {
+    std::ofstream file(path);
+    file << "VERSION 0.7\nFIELDS x y label\nSIZE 4 8 4\nTYPE F F U\n"
+         << "COUNT 1 1 1\nWIDTH " << n << "\nHEIGHT 1\nPOINTS " << n
+         << "\nDATA ascii\n";
+    for (size_t i = 0; i < n; i++) {
+      file << (i * 0.5f) << " " << std::setprecision(17) << (i / 3.0) << " "
+           << (i % 11) << (i % 2 ? "\r\n" : "\n");
+    }
+    file << "\n1.5 2.5\n"; // Blank line, then a short line
+  }
+
+  pcd::ParseOptions single;
+  single.threads = 1;
+  pcd::ParseOptions multi;
+  multi.threads = 7;
+  pcd::PCDData a = pcd::PCDParser::parse(path, single);
+  pcd::PCDData b = pcd::PCDParser::parse(path, multi);
+
+  ASSERT_EQ(a.numPoints(), n + 1);
+  EXPECT_EQ(a.fieldData, b.fieldData);
+  EXPECT_FLOAT_EQ(std::get<std::vector<float>>(b.fieldData[0])[n - 1],
+                  (n - 1) * 0.5f);
+  EXPECT_DOUBLE_EQ(std::get<std::vector<double>>(b.fieldData[1])[n - 1],
+                   (n - 1) / 3.0);
+  EXPECT_EQ(b.getLabels()[n - 1], (n - 1) % 11);
+  EXPECT_EQ(b.getLabels()[n], 0u); // Missing value padded with default
+}
+
+// Encode bytes as an LZF stream of literal runs (valid, uncompressed LZF)
+static std::string lzfLiterals(const std::vector<uint8_t> &bytes) {
+  std::string out;
+  for (size_t i = 0; i < bytes.size(); i += 32) {
+    size_t run = std::min<size_t>(32, bytes.size() - i);
+    out.push_back(static_cast<char>(run - 1));
+    out.append(reinterpret_cast<const char *>(bytes.data() + i), run);
+  }
+  return out;
+}
+
+// Test binary_compressed columns, including a COUNT > 1 field
+TEST(PCDParser, BinaryCompressedColumns) {
+  std::vector<float> xs = {1.5f, -2.0f, 3.25f};
+  std::vector<uint16_t> packed = {10, 11, 20, 21, 30, 31}; // COUNT 2
+  std::vector<uint8_t> raw(xs.size() * 4 + packed.size() * 2);
+  std::memcpy(raw.data(), xs.data(), xs.size() * 4);
+  std::memcpy(raw.data() + xs.size() * 4, packed.data(), packed.size() * 2);
+  std::string blob = lzfLiterals(raw);
+
+  std::string path = testing::TempDir() + "compressed_columns.pcd";
+  auto writeFile = [&](size_t blobBytes) {
+    std::ofstream file(path, std::ios::binary);
+    file << "VERSION 0.7\nFIELDS x n\nSIZE 4 2\nTYPE F U\nCOUNT 1 2\n"
+         << "WIDTH 3\nHEIGHT 1\nPOINTS 3\nDATA binary_compressed\n";
+    uint32_t sizes[2] = {static_cast<uint32_t>(blob.size()),
+                         static_cast<uint32_t>(raw.size())};
+    file.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+    file.write(blob.data(), blobBytes);
+  };
+
+  writeFile(blob.size());
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+  ASSERT_EQ(parsed.numPoints(), 3);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs);
+  EXPECT_EQ(std::get<std::vector<uint16_t>>(parsed.fieldData[1]),
+            (std::vector<uint16_t>{10, 20, 30}));
+
+  // A truncated payload is rejected
+  writeFile(blob.size() - 5);
+  EXPECT_THROW(pcd::PCDParser::parse(path), std::runtime_error);
+}
+
+// Test that probe reads the header and data location without the points
+TEST(PCDParser, Probe) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+  data.fieldData.push_back(std::vector<float>{1.0f, 2.0f, 3.0f});
+  data.fieldData.push_back(std::vector<uint32_t>{4, 5, 6});
+
+  std::string path = testing::TempDir() + "probe.pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+
+  pcd::PCDFileInfo info = pcd::PCDParser::probe(path);
+  EXPECT_EQ(info.header.points, 3);
+  EXPECT_EQ(info.header.dataType, "binary");
+  EXPECT_EQ(info.header.findField("label"), 1);
+  EXPECT_EQ(info.dataSize, 3u * 8u);
+  EXPECT_EQ(info.dataOffset + info.dataSize, info.fileSize);
+
+  EXPECT_THROW(pcd::PCDParser::probe(path + ".missing"), std::runtime_error);
+}
+
+// Test that labels are patched in place in binary files only
+TEST(PCDParser, PatchLabels) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+  data.header.addField("y", 2, 'I', 1);
+
+  const size_t n = 1000;
+  std::vector<float> xs(n);
+  std::vector<uint32_t> labels(n, 0);
+  std::vector<int16_t> ys(n);
+  std::vector<uint32_t> patched(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i) * 0.25f;
+    ys[i] = static_cast<int16_t>(-static_cast<int>(i));
+    patched[i] = static_cast<uint32_t>(i % 7);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(labels);
+  data.fieldData.push_back(ys);
+
+  std::string path = testing::TempDir() + "patch_labels.pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+  EXPECT_TRUE(pcd::PCDParser::patchLabels(path, patched));
+
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+  ASSERT_EQ(parsed.numPoints(), n);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs);
+  EXPECT_EQ(parsed.getLabels(), patched);
+  EXPECT_EQ(std::get<std::vector<int16_t>>(parsed.fieldData[2]), ys);
+
+  // Wrong label count and non-binary files are left to the full rewrite
+  EXPECT_FALSE(pcd::PCDParser::patchLabels(path, std::vector<uint32_t>(n - 1)));
+  std::string asciiPath = testing::TempDir() + "patch_labels_ascii.pcd";
+  pcd::PCDParser::write(asciiPath, data, std::string("ascii"));
+  EXPECT_FALSE(pcd::PCDParser::patchLabels(asciiPath, patched));
+}
+
+// Test label runs applied in place and through a full rewrite
+TEST(PCDParser, ApplyLabelDelta) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+
+  const size_t n = 500;
+  std::vector<float> xs(n);
+  std::vector<uint32_t> labels(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i);
+    labels[i] = static_cast<uint32_t>(i % 3);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(labels);
+
+  std::vector<pcd::LabelRun> runs = {{10, 5, 7}, {499, 1, 9}, {0, 0, 4}};
+  std::vector<uint32_t> expected = labels;
+  for (size_t i = 10; i < 15; i++)
+    expected[i] = 7;
+  expected[499] = 9;
+
+  std::string path = testing::TempDir() + "label_delta.pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+  size_t size = pcd::PCDParser::probe(path).fileSize;
+  pcd::PCDParser::applyLabelDelta(path, runs);
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+  EXPECT_EQ(parsed.getLabels(), expected);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs);
+  EXPECT_EQ(pcd::PCDParser::probe(path).fileSize, size);
+
+  // ascii input, converted on the way
+  std::string asciiPath = testing::TempDir() + "label_delta_ascii.pcd";
+  pcd::PCDParser::write(asciiPath, data, std::string("ascii"));
+  pcd::PCDParser::applyLabelDelta(asciiPath, runs, "binary_compressed");
+  parsed = pcd::PCDParser::parse(asciiPath);
+  EXPECT_EQ(parsed.header.dataType, "binary_compressed");
+  EXPECT_EQ(parsed.getLabels(), expected);
+
+  // Out of range runs are rejected before anything is written
+  EXPECT_THROW(pcd::PCDParser::applyLabelDelta(path, {{498, 3, 1}}),
+               std::runtime_error);
+  EXPECT_EQ(pcd::PCDParser::parse(path).getLabels(), expected);
+}
+
+// Test voxel grouping, representatives and label expansion
+TEST(PCDParser, VoxelGrid) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("y", 4, 'F', 1);
+  data.header.addField("z", 8, 'F', 1); // Converted for the grid
+  data.header.addField("label", 4, 'U', 1);
+
+  // A 40 x 40 grid of points at spacing 0.25, in shuffled order
+  const size_t n = 1600;
+  std::vector<float> xs(n), ys(n);
+  std::vector<double> zs(n, 1.0);
+  for (size_t i = 0; i < n; i++) {
+    size_t cell = (i * 7) % n;
+    xs[i] = 0.25f * (cell % 40);
+    ys[i] = 0.25f * (cell / 40);
+  }
+  xs[5] = NAN; // Left out of every voxel
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(ys);
+  data.fieldData.push_back(zs);
+  data.fieldData.push_back(std::vector<uint32_t>(n, 0));
+
+  pcd::VoxelGrid grid = pcd::PCDParser::voxelGrid(data, 1.0, 4);
+  ASSERT_EQ(grid.voxelOf.size(), n);
+  EXPECT_EQ(grid.voxelOf[5], pcd::VoxelGrid::kNoVoxel);
+  ASSERT_EQ(grid.representatives.size(), 100u); // 10 x 10 unit voxels
+  EXPECT_TRUE(std::is_sorted(grid.representatives.begin(),
+                             grid.representatives.end()));
+
+  std::vector<size_t> members(grid.representatives.size(), 0);
+  for (size_t i = 0; i < n; i++) {
+    if (i == 5)
+      continue;
+    uint32_t voxel = grid.voxelOf[i];
+    ASSERT_LT(voxel, grid.representatives.size());
+    members[voxel]++;
+    // Members share their representative's voxel
+    uint32_t rep = grid.representatives[voxel];
+    EXPECT_EQ(std::floor(xs[i]), std::floor(xs[rep]));
+    EXPECT_EQ(std::floor(ys[i]), std::floor(ys[rep]));
+  }
+  for (size_t v = 0; v < members.size(); v++) {
+    EXPECT_EQ(grid.voxelOf[grid.representatives[v]], v);
+    // The representative is nearest the voxel's center (0.5, 0.5 offsets)
+    uint32_t rep = grid.representatives[v];
+    EXPECT_FLOAT_EQ(xs[rep] - std::floor(xs[rep]), 0.5f);
+    EXPECT_FLOAT_EQ(ys[rep] - std::floor(ys[rep]), 0.5f);
+  }
+
+  // The result does not depend on the thread count
+  pcd::VoxelGrid single = pcd::PCDParser::voxelGrid(data, 1.0, 1);
+  EXPECT_EQ(single.representatives, grid.representatives);
+  EXPECT_EQ(single.voxelOf, grid.voxelOf);
+
+  pcd::PCDData preview = pcd::PCDParser::subset(data, grid.representatives);
+  EXPECT_EQ(preview.header.points, 100);
+  EXPECT_EQ(preview.numPoints(), 100u);
+  EXPECT_EQ(std::get<std::vector<double>>(preview.fieldData[2]).size(), 100u);
+
+  // Labels on voxels 3 and 4 reach every member point
+  std::vector<pcd::LabelRun> runs = grid.expand({{3, 2, 6}});
+  std::vector<uint32_t> labels(n, 0);
+  for (const auto &run : runs) {
+    for (uint32_t i = run.start; i < run.start + run.count; i++)
+      labels[i] = run.label;
+  }
+  size_t labelled = 0;
+  for (size_t i = 0; i < n; i++) {
+    bool inVoxel = grid.voxelOf[i] == 3 || grid.voxelOf[i] == 4;
+    EXPECT_EQ(labels[i], inVoxel ? 6u : 0u);
+    labelled += inVoxel;
+  }
+  EXPECT_EQ(labelled, members[3] + members[4]);
+  EXPECT_THROW(grid.expand({{99, 2, 1}}), std::runtime_error);
+
+  EXPECT_THROW(pcd::PCDParser::voxelGrid(data, 0.0), std::runtime_error);
+  EXPECT_THROW(pcd::PCDParser::voxelGrid(data, 1e-9), std::runtime_error);
+}
+
+// Test the record layout produced by the blocked binary writer
+TEST(PCDParser, BinaryWriterLayout) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("ring", 1, 'U', 1);
+  data.header.addField("t", 8, 'F', 1);
+
+  const size_t n = 16384 + 3; // One full block plus a partial one
+  std::vector<float> xs(n);
+  std::vector<uint8_t> rings(n);
+  std::vector<double> ts(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i) * 1.5f;
+    rings[i] = static_cast<uint8_t>(i % 64);
+    ts[i] = static_cast<double>(i) * 1e-3;
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(rings);
+  data.fieldData.push_back(ts);
+
+  std::string path = testing::TempDir() + "binary_writer_layout.pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+
+  pcd::PCDFileInfo info = pcd::PCDParser::probe(path);
+  ASSERT_EQ(info.dataSize, n * 13);
+
+  std::ifstream file(path, std::ios::binary);
+  std::vector<char> bytes(info.fileSize);
+  file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  const char *records = bytes.data() + info.dataOffset;
+  for (size_t i : {size_t(0), size_t(1), size_t(16383), size_t(16384), n - 1}) {
+    float x;
+    double t;
+    std::memcpy(&x, records + i * 13, 4);
+    std::memcpy(&t, records + i * 13 + 5, 8);
+    EXPECT_EQ(x, xs[i]);
+    EXPECT_EQ(static_cast<uint8_t>(records[i * 13 + 4]), rings[i]);
+    EXPECT_EQ(t, ts[i]);
+  }
+}
+
+// Test that the ascii writer round-trips floats and doubles exactly
+TEST(PCDParser, AsciiWriterRoundTrip) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("t", 8, 'F', 1);
+  data.header.addField("ring", 2, 'I', 1);
+
+  const size_t n = 70000; // Spans several formatting tasks
+  std::vector<float> xs(n);
+  std::vector<double> ts(n);
+  std::vector<int16_t> rings(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i) * 0.1f - 7.3f;
+    ts[i] = 1.7e9 + static_cast<double>(i) * 1e-7;
+    rings[i] = static_cast<int16_t>(static_cast<int>(i % 128) - 64);
+  }
+  xs[1] = 6.17e-39f; // Packed-rgb style denormal
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(ts);
+  data.fieldData.push_back(rings);
+
+  std::string path = testing::TempDir() + "ascii_writer.pcd";
+  pcd::PCDParser::write(path, data, std::string("ascii"));
+  pcd::PCDData parsed = pcd::PCDParser::parse(path);
+
+  ASSERT_EQ(parsed.numPoints(), n);
+  EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs);
+  EXPECT_EQ(std::get<std::vector<double>>(parsed.fieldData[1]), ts);
+  EXPECT_EQ(std::get<std::vector<int16_t>>(parsed.fieldData[2]), rings);
+
+  // Shortest round-trip text for the first record
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line) && line.rfind("DATA", 0) != 0) {
+  }
+  std::getline(file, line);
+  EXPECT_EQ(line, "-7.3 1.7e+09 -64");
+}
+
+// Test that a field subset decodes only the requested columns
+TEST(PCDParser, FieldSubset) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("intensity", 4, 'F', 1);
+  data.header.addField("ring", 2, 'U', 1);
+  data.header.addField("label", 4, 'U', 1);
+
+  const size_t n = 500;
+  std::vector<float> xs(n), intensity(n);
+  std::vector<uint16_t> rings(n);
+  std::vector<uint32_t> labels(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i);
+    intensity[i] = static_cast<float>(i) * 2.0f;
+    rings[i] = static_cast<uint16_t>(i % 16);
+    labels[i] = static_cast<uint32_t>(i % 3);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(intensity);
+  data.fieldData.push_back(rings);
+  data.fieldData.push_back(labels);
+
+  pcd::ParseOptions options;
+  options.fields = {"X", "label", "missing"};
+  for (const std::string format : {"ascii", "binary", "binary_compressed"}) {
+    std::string path = testing::TempDir() + "subset_" + format + ".pcd";
+    pcd::PCDParser::write(path, data, format);
+    pcd::PCDData parsed = pcd::PCDParser::parse(path, options);
+
+    ASSERT_EQ(parsed.fieldData.size(), 4u) << format;
+    EXPECT_EQ(parsed.numPoints(), n) << format;
+    EXPECT_EQ(std::get<std::vector<float>>(parsed.fieldData[0]), xs) << format;
+    EXPECT_TRUE(std::get<std::vector<float>>(parsed.fieldData[1]).empty())
+        << format;
+    EXPECT_TRUE(std::get<std::vector<uint16_t>>(parsed.fieldData[2]).empty())
+        << format;
+    EXPECT_EQ(parsed.getLabels(), labels) << format;
+  }
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,59 @@
+#include "pcd_parser/pcd_prefetcher.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string writeFrame(int index) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+  data.fieldData.push_back(std::vector<float>(64, static_cast<float>(index)));
+  data.fieldData.push_back(std::vector<uint32_t>(64, 1));
+
+  std::string path =
+      testing::TempDir() + "prefetch_" + std::to_string(index) + ".pcd";
+  pcd::PCDParser::write(path, data, std::string("binary"));
+  return path;
+}
+
+} // namespace
+
+// Test that prefetched frames are served from the cache
+TEST(PCDPrefetcher, WarmsCache) {
+  std::vector<std::string> frames;
+  for (int i = 0; i < 4; i++)
+    frames.push_back(writeFrame(i));
+  frames.push_back(testing::TempDir() + "prefetch_missing.pcd");
+
+  pcd::PCDCache cache(64 << 20);
+  pcd::PCDPrefetcher prefetcher(cache, 2);
+  prefetcher.schedule(frames);
+  prefetcher.wait();
+  EXPECT_EQ(prefetcher.pending(), 0u);
+  EXPECT_EQ(cache.stats().entries, 4u); // Missing file is skipped
+
+  uint64_t misses = cache.stats().misses;
+  auto frame = cache.get(frames[2]);
+  EXPECT_EQ(cache.stats().misses, misses);
+  EXPECT_EQ(std::get<std::vector<float>>(frame->fieldData[0])[0], 2.0f);
+}
+
+// Test that a new schedule replaces the pending queue
+TEST(PCDPrefetcher, ScheduleReplacesQueue) {
+  std::vector<std::string> frames;
+  for (int i = 0; i < 4; i++)
+    frames.push_back(writeFrame(i));
+
+  pcd::PCDCache cache(64 << 20);
+  pcd::PCDPrefetcher prefetcher(cache, 1);
+  prefetcher.schedule(frames);
+  prefetcher.cancel();
+  prefetcher.schedule({frames[3]});
+  prefetcher.wait();
+
+  // At most the frame already running when cancelled, plus frames[3]
+  EXPECT_LE(cache.stats().entries, 2u);
+  uint64_t misses = cache.stats().misses;
+  cache.get(frames[3]);
+  EXPECT_EQ(cache.stats().misses, misses);
+}
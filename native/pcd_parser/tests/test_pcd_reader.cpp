@@ -0,0 +1,100 @@
+#include "pcd_parser/pcd_reader.h"
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace {
+
+pcd::PCDData makeCloud(size_t n) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("t", 8, 'F', 1);
+  data.header.addField("ring", 2, 'U', 1);
+  data.header.addField("label", 4, 'U', 1);
+
+  std::vector<float> xs(n);
+  std::vector<double> ts(n);
+  std::vector<uint16_t> rings(n);
+  std::vector<uint32_t> labels(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(i) * 0.5f;
+    ts[i] = static_cast<double>(i) * 1e-3;
+    rings[i] = static_cast<uint16_t>(i % 32);
+    labels[i] = static_cast<uint32_t>(i % 5);
+  }
+  data.fieldData.push_back(xs);
+  data.fieldData.push_back(ts);
+  data.fieldData.push_back(rings);
+  data.fieldData.push_back(labels);
+  return data;
+}
+
+// Read a whole file through PCDReader, appending the chunks column-wise
+pcd::PCDData readAll(const std::string &path, size_t chunkPoints,
+                     std::vector<size_t> &chunkSizes) {
+  pcd::PCDReader reader(path, chunkPoints);
+  pcd::PCDData all;
+  all.header = reader.header();
+  for (const auto &field : all.header.fields) {
+    all.fieldData.push_back(field.createStorage());
+  }
+
+  pcd::PCDData chunk;
+  while (reader.next(chunk)) {
+    chunkSizes.push_back(chunk.numPoints());
+    for (size_t f = 0; f < chunk.fieldData.size(); f++) {
+      std::visit(
+          [&](auto &dst) {
+            using Vec = std::decay_t<decltype(dst)>;
+            const auto &src = std::get<Vec>(chunk.fieldData[f]);
+            dst.insert(dst.end(), src.begin(), src.end());
+          },
+          all.fieldData[f]);
+    }
+  }
+  EXPECT_EQ(reader.pointsRead(), all.numPoints());
+  return all;
+}
+
+} // namespace
+
+// Test that chunked reads match a full parse for every data format
+TEST(PCDReader, ChunksMatchParse) {
+  const size_t n = 2500;
+  pcd::PCDData data = makeCloud(n);
+
+  for (const std::string format : {"ascii", "binary", "binary_compressed"}) {
+    std::string path = testing::TempDir() + "reader_" + format + ".pcd";
+    pcd::PCDParser::write(path, data, format);
+    pcd::PCDData parsed = pcd::PCDParser::parse(path);
+
+    std::vector<size_t> chunkSizes;
+    pcd::PCDData chunked = readAll(path, 1000, chunkSizes);
+
+    EXPECT_EQ(chunkSizes, (std::vector<size_t>{1000, 1000, 500})) << format;
+    ASSERT_EQ(chunked.fieldData.size(), parsed.fieldData.size()) << format;
+    for (size_t f = 0; f < parsed.fieldData.size(); f++) {
+      EXPECT_EQ(chunked.fieldData[f], parsed.fieldData[f])
+          << format << " field " << f;
+    }
+  }
+}
+
+// Test ascii chunking across blank lines and a missing final newline
+TEST(PCDReader, AsciiBlankLines) {
+  std::string path = testing::TempDir() + "reader_blank.pcd";
+  {
+    std::ofstream file(path);
+    file << "VERSION 0.7\nFIELDS x y\nSIZE 4 4\nTYPE F F\nCOUNT 1 1\n"
+         << "WIDTH 3\nHEIGHT 1\nPOINTS 3\nDATA ascii\n"
+         << "1 2\n\n   \n3 4\r\n5 6";
+  }
+
+  std::vector<size_t> chunkSizes;
+  pcd::PCDData chunked = readAll(path, 2, chunkSizes);
+
+  EXPECT_EQ(chunkSizes, (std::vector<size_t>{2, 1}));
+  EXPECT_EQ(std::get<std::vector<float>>(chunked.fieldData[0]),
+            (std::vector<float>{1, 3, 5}));
+  EXPECT_EQ(std::get<std::vector<float>>(chunked.fieldData[1]),
+            (std::vector<float>{2, 4, 6}));
+}
@@ -0,0 +1,65 @@
+#include "pcd_parser/pcd_scanner.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void writeCloud(const fs::path &path, size_t n) {
+  pcd::PCDData data;
+  data.header.addField("x", 4, 'F', 1);
+  data.header.addField("label", 4, 'U', 1);
+  data.fieldData.push_back(std::vector<float>(n, 1.0f));
+  data.fieldData.push_back(std::vector<uint32_t>(n, 0));
+  pcd::PCDParser::write(path.string(), data, std::string("binary"));
+}
+
+} // namespace
+
+// Test enumeration, filtering and header probing
+TEST(PCDScanner, ScanTree) {
+  fs::path root = fs::path(testing::TempDir()) / "scan_tree";
+  fs::remove_all(root);
+  fs::create_directories(root / "seq1" / "sub");
+  fs::create_directories(root / "empty");
+  fs::create_directories(root / ".hidden");
+  writeCloud(root / "seq1" / "000.pcd", 10);
+  writeCloud(root / "seq1" / "sub" / "001.PCD", 20);
+  writeCloud(root / ".hidden" / "002.pcd", 5);
+  std::ofstream(root / "seq1" / "notes.txt") << "x";
+  std::ofstream(root / "broken.pcd") << "not a pcd";
+
+  pcd::ScanOptions options;
+  options.threads = 4;
+  pcd::ScanResult result = pcd::PCDScanner::scan(root.string(), options);
+  EXPECT_EQ(result.directories,
+            (std::vector<std::string>{"empty", "seq1", "seq1/sub"}));
+  ASSERT_EQ(result.files.size(), 3u);
+  EXPECT_EQ(result.files[0].path, "broken.pcd");
+  EXPECT_EQ(result.files[1].path, "seq1/000.pcd");
+  EXPECT_EQ(result.files[2].path, "seq1/sub/001.PCD");
+  EXPECT_FALSE(result.files[1].probed);
+
+  options.probe = true;
+  options.recursive = false;
+  result = pcd::PCDScanner::scan((root / "seq1").string(), options);
+  EXPECT_EQ(result.directories, (std::vector<std::string>{"sub"}));
+  ASSERT_EQ(result.files.size(), 1u);
+  EXPECT_TRUE(result.files[0].probed);
+  EXPECT_EQ(result.files[0].info.header.points, 10);
+
+  std::vector<pcd::ScannedFile> files(2);
+  files[0].path = "missing.pcd";
+  files[1].path = "seq1/sub/001.PCD";
+  pcd::PCDScanner::probe(root.string(), files, 2);
+  EXPECT_FALSE(files[0].probed);
+  EXPECT_TRUE(files[1].probed);
+  EXPECT_EQ(files[1].info.header.points, 20);
+
+  // A missing root is an empty result
+  result = pcd::PCDScanner::scan((root / "missing").string());
+  EXPECT_TRUE(result.files.empty());
+  EXPECT_TRUE(result.directories.empty());
+}
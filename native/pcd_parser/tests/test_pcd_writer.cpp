@@ -0,0 +1,88 @@
+#include "pcd_parser/pcd_reader.h"
+#include "pcd_parser/pcd_writer.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+namespace {
+
+pcd::PCDData makeChunk(size_t first, size_t n) {
+  pcd::PCDData chunk;
+  chunk.header.addField("x", 4, 'F', 1);
+  chunk.header.addField("intensity", 2, 'U', 1);
+  chunk.header.addField("label", 4, 'U', 1);
+
+  std::vector<float> xs(n);
+  std::vector<uint16_t> intensity(n);
+  std::vector<uint32_t> labels(n);
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = static_cast<float>(first + i) * 0.25f;
+    intensity[i] = static_cast<uint16_t>((first + i) * 7);
+    labels[i] = static_cast<uint32_t>((first + i) % 4);
+  }
+  chunk.fieldData.push_back(xs);
+  chunk.fieldData.push_back(intensity);
+  chunk.fieldData.push_back(labels);
+  return chunk;
+}
+
+} // namespace
+
+// Test that appended chunks parse back as one cloud in every format
+TEST(PCDWriter, AppendChunks) {
+  const size_t sizes[] = {700, 0, 1300, 5};
+  for (const std::string format : {"ascii", "binary", "binary_compressed"}) {
+    std::string path = testing::TempDir() + "writer_" + format + ".pcd";
+    pcd::PCDHeader header = makeChunk(0, 0).header;
+
+    pcd::PCDWriter writer(path, header, format);
+    size_t first = 0;
+    for (size_t n : sizes) {
+      writer.append(makeChunk(first, n));
+      first += n;
+    }
+    writer.close();
+    EXPECT_EQ(writer.pointsWritten(), first);
+
+    pcd::PCDData parsed = pcd::PCDParser::parse(path);
+    pcd::PCDData expected = makeChunk(0, first);
+    EXPECT_EQ(parsed.header.points, static_cast<int>(first)) << format;
+    EXPECT_EQ(parsed.header.width, static_cast<int>(first)) << format;
+    ASSERT_EQ(parsed.fieldData.size(), expected.fieldData.size()) << format;
+    for (size_t f = 0; f < expected.fieldData.size(); f++) {
+      EXPECT_EQ(parsed.fieldData[f], expected.fieldData[f])
+          << format << " field " << f;
+    }
+  }
+}
+
+// Test converting through PCDReader and PCDWriter chunk by chunk
+TEST(PCDWriter, ConvertFromReader) {
+  std::string src = testing::TempDir() + "writer_convert_src.pcd";
+  std::string dst = testing::TempDir() + "writer_convert_dst.pcd";
+  pcd::PCDParser::write(src, makeChunk(0, 3000), std::string("ascii"));
+
+  pcd::PCDReader reader(src, 512);
+  pcd::PCDWriter writer(dst, reader.header(), "binary_compressed");
+  pcd::PCDData chunk;
+  while (reader.next(chunk)) {
+    writer.append(chunk);
+  }
+  writer.close();
+
+  EXPECT_EQ(pcd::PCDParser::parse(dst).fieldData,
+            pcd::PCDParser::parse(src).fieldData);
+}
+
+// Test that mismatched chunks are rejected and unclosed writers leave no file
+TEST(PCDWriter, RejectsAndDiscards) {
+  std::string path = testing::TempDir() + "writer_discard.pcd";
+  std::filesystem::remove(path);
+  {
+    pcd::PCDWriter writer(path, makeChunk(0, 0).header, "binary");
+    pcd::PCDData wrong = makeChunk(0, 10);
+    wrong.fieldData[1] = std::vector<float>(10);
+    EXPECT_THROW(writer.append(wrong), std::runtime_error);
+    writer.append(makeChunk(0, 10));
+  }
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
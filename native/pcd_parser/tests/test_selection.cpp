@@ -0,0 +1,147 @@
+#include "pcd_parser/selection.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+// Perspective camera at (0, 0, 50) looking down -z, as THREE would build it
+pcd::SelectionView cameraView() {
+  const float fovY = 60.0f * 3.14159265f / 180.0f, aspect = 800.0f / 600.0f;
+  const float near = 0.1f, far = 1000.0f, eyeZ = 50.0f;
+  float f = 1.0f / std::tan(fovY / 2);
+  float a = (far + near) / (near - far), b = 2 * far * near / (near - far);
+
+  pcd::SelectionView view;
+  std::fill(std::begin(view.matrix), std::end(view.matrix), 0.0f);
+  view.matrix[0] = f / aspect;
+  view.matrix[5] = f;
+  view.matrix[10] = a;
+  view.matrix[11] = -1;
+  view.matrix[14] = -a * eyeZ + b;
+  view.matrix[15] = eyeZ;
+  view.left = 10;
+  view.top = 20;
+  view.width = 800;
+  view.height = 600;
+  return view;
+}
+
+// Concave star-shaped lasso around the middle of the viewport
+std::vector<pcd::ScreenPoint> starPolygon() {
+  std::vector<pcd::ScreenPoint> polygon;
+  for (int i = 0; i < 40; i++) {
+    float angle = i * 2 * 3.14159265f / 40;
+    float radius = i % 2 ? 90.0f : 260.0f;
+    polygon.push_back({410 + radius * std::cos(angle),
+                       320 + radius * std::sin(angle) * 0.8f});
+  }
+  return polygon;
+}
+
+std::vector<float> randomCloud(size_t n) {
+  std::mt19937 rng(11);
+  std::normal_distribution<float> spread(0.0f, 12.0f);
+  std::vector<float> xyz;
+  for (size_t i = 0; i < n; i++) {
+    xyz.push_back(spread(rng));
+    xyz.push_back(spread(rng));
+    // Some points behind the camera, which must never be selected
+    xyz.push_back(i % 50 == 0 ? 80.0f : spread(rng) * 0.5f);
+  }
+  xyz[5 * 3] = NAN;
+  return xyz;
+}
+
+// Per-point reference with the selector's own exact polygon test
+std::vector<uint8_t> bruteForce(const pcd::PolygonSelector &selector,
+                                const pcd::SelectionView &view,
+                                const std::vector<float> &xyz) {
+  const float *m = view.matrix;
+  size_t n = xyz.size() / 3;
+  std::vector<uint8_t> bits((n + 7) / 8, 0);
+  for (size_t i = 0; i < n; i++) {
+    float x = xyz[i * 3], y = xyz[i * 3 + 1], z = xyz[i * 3 + 2];
+    float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+    float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+    float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+    float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+    if (!(cw > 0 && cz <= cw))
+      continue;
+    float invW = 1.0f / cw;
+    float sx = view.left + view.width * 0.5f + cx * invW * view.width * 0.5f;
+    float sy = view.top + view.height * 0.5f - cy * invW * view.height * 0.5f;
+    if (selector.contains(sx, sy))
+      bits[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+  }
+  return bits;
+}
+
+size_t countBits(const std::vector<uint8_t> &bits) {
+  size_t count = 0;
+  for (uint8_t byte : bits) {
+    for (; byte; byte &= byte - 1)
+      count++;
+  }
+  return count;
+}
+
+} // namespace
+
+TEST(PolygonSelector, ContainsUsesEvenOddRule) {
+  pcd::SelectionView view = cameraView();
+  // Square with a square hole traced as one self-overlapping ring
+  pcd::PolygonSelector selector(
+      view, {{0, 0}, {100, 0}, {100, 100}, {0, 100}, {0, 0},
+             {25, 25}, {25, 75}, {75, 75}, {75, 25}, {25, 25}});
+  EXPECT_TRUE(selector.contains(10, 50));
+  EXPECT_FALSE(selector.contains(50, 50));
+  EXPECT_FALSE(selector.contains(150, 50));
+}
+
+// Flat and octree selection both match per-point projection
+TEST(PolygonSelector, MatchesBruteForce) {
+  const size_t n = 150003;
+  std::vector<float> xyz = randomCloud(n);
+  pcd::SelectionView view = cameraView();
+  pcd::PolygonSelector selector(view, starPolygon());
+
+  std::vector<uint8_t> expected = bruteForce(selector, view, xyz);
+  size_t selected = countBits(expected);
+  EXPECT_GT(selected, n / 10);
+  EXPECT_LT(selected, n / 2);
+
+  std::vector<uint8_t> flat = selector.select(xyz.data(), n, 4);
+  EXPECT_EQ(flat, expected);
+
+  std::vector<float> x(n), y(n), z(n);
+  for (size_t i = 0; i < n; i++) {
+    x[i] = xyz[i * 3];
+    y[i] = xyz[i * 3 + 1];
+    z[i] = xyz[i * 3 + 2];
+  }
+  pcd::OctreeOptions options;
+  options.leafSize = 32;
+  pcd::Octree tree = pcd::Octree::build(x.data(), y.data(), z.data(), n,
+                                        options);
+  std::vector<uint8_t> culled = selector.select(tree, n, 4);
+  EXPECT_EQ(culled, expected);
+}
+
+TEST(PolygonSelector, DegenerateInput) {
+  std::vector<float> xyz = randomCloud(100);
+  pcd::SelectionView view = cameraView();
+
+  pcd::PolygonSelector line(view, {{0, 0}, {800, 600}});
+  std::vector<uint8_t> bits = line.select(xyz.data(), 100);
+  EXPECT_EQ(bits.size(), 13u);
+  EXPECT_EQ(countBits(bits), 0u);
+
+  // A polygon covering the whole viewport takes every visible point
+  pcd::PolygonSelector all(view, {{0, 0}, {1000, 0}, {1000, 1000}, {0, 1000}});
+  EXPECT_EQ(countBits(all.select(xyz.data(), 100)),
+            countBits(bruteForce(all, view, xyz)));
+
+  EXPECT_THROW(pcd::PolygonSelector(view, {{0, 0}, {NAN, 1}, {2, 2}}),
+               std::runtime_error);
+}
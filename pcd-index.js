@@ -0,0 +1,438 @@
+const fs = require('fs');
+const path = require('path');
+
+// In-memory index of the PCD files under directory roots, used by
+// /api/files and /api/browse instead of rescanning the tree per request.
+// A root is scanned once, asynchronously, then kept current by fs.watch.
+// Hidden entries are skipped and symlinks are not followed, as before.
+//
+// An optional backend speeds up large roots:
+//   scan(root) -> Promise<{ directories, files }> with paths relative to
+//                 root (the initial tree walk)
+//   probe(paths) -> Promise<Array<meta | null>> (header metadata, cached per
+//                 file until it changes)
+
+const READDIR_CONCURRENCY = 32;   // Parallel readdir calls while scanning
+const EVENT_DELAY_MS = 100;       // Watch events are coalesced over this window
+const UNWATCHED_TTL_MS = 30000;   // Rebuild interval when watching failed
+const MAX_ROOTS = 8;
+
+// FSEvents / ReadDirectoryChangesW watch a whole tree natively; elsewhere
+// (inotify) Node's recursive mode falls back to polling, so each directory
+// gets its own watcher instead
+const NATIVE_RECURSIVE_WATCH = process.platform === 'darwin' || process.platform === 'win32';
+
+function isPcdName(name) {
+    return name.toLowerCase().endsWith('.pcd');
+}
+
+function byName(a, b) {
+    return a.localeCompare(b);
+}
+
+class DirNode {
+    constructor(dirPath, parent) {
+        this.path = dirPath;
+        this.name = path.basename(dirPath);
+        this.parent = parent;
+        this.files = new Set();     // PCD file names
+        this.children = new Map();  // Directory name -> DirNode
+        this.meta = new Map();      // File name -> probed header metadata
+        this.count = 0;             // PCD files in this subtree
+        this.watcher = null;
+        this.sortedFiles = null;    // Cached sort orders, reset on change
+        this.sortedChildren = null;
+    }
+
+    fileNames() {
+        if (!this.sortedFiles) this.sortedFiles = [...this.files].sort(byName);
+        return this.sortedFiles;
+    }
+
+    childNodes() {
+        if (!this.sortedChildren) {
+            this.sortedChildren = [...this.children.values()].sort((a, b) => byName(a.name, b.name));
+        }
+        return this.sortedChildren;
+    }
+}
+
+class PcdIndex {
+    constructor(root, backend = {}) {
+        this.root = root;
+        this.backend = backend;
+        this.rootNode = new DirNode(root, null);
+        this.live = true;           // False once a watcher could not be set up
+        this.disposed = false;
+        this.builtAt = 0;
+        this.activeReads = 0;
+        this.readWaiters = [];
+        this.pendingEvents = new Set();
+        this.eventTimer = null;
+
+        if (NATIVE_RECURSIVE_WATCH) {
+            try {
+                this.treeWatcher = fs.watch(root, { recursive: true }, (event, filename) => {
+                    this.queueEvent(filename ? path.join(root, filename.toString()) : root);
+                });
+                this.treeWatcher.on('error', err => this.watchFailed(err));
+            } catch (err) {
+                this.watchFailed(err);
+            }
+        }
+
+        const built = backend.scan ? this.scanWithBackend() : this.scan(this.rootNode);
+        this.ready = built.then(() => {
+            this.builtAt = Date.now();
+            return this;
+        });
+    }
+
+    // Directory node for dirPath, or null when outside the index
+    node(dirPath) {
+        const relative = path.relative(this.root, dirPath);
+        if (relative.startsWith('..') || path.isAbsolute(relative)) return null;
+        let node = this.rootNode;
+        for (const part of relative.split(path.sep)) {
+            if (!part) continue;
+            node = node.children.get(part);
+            if (!node) return null;
+        }
+        return node;
+    }
+
+    // Unwatched indexes are only trusted for UNWATCHED_TTL_MS
+    isStale() {
+        return !this.live && this.builtAt > 0 && Date.now() - this.builtAt > UNWATCHED_TTL_MS;
+    }
+
+    // Immediate contents of dirPath: sorted subdirectories with recursive
+    // PCD counts, and the sorted PCD file names directly inside it
+    list(dirPath) {
+        const node = this.node(dirPath);
+        if (!node) return null;
+        return {
+            directories: node.childNodes().map(child => ({
+                name: child.name,
+                path: child.path,
+                pcdCount: child.count
+            })),
+            files: node.fileNames(),
+            pcdCount: node.files.size
+        };
+    }
+
+    // Folder tree under dirPath holding only folders that contain PCD files
+    // (the shape /api/files has always returned). Visits only those folders.
+    tree(dirPath) {
+        const node = this.node(dirPath);
+        return node ? this.buildTree(node, dirPath) : null;
+    }
+
+    buildTree(node, basePath) {
+        return {
+            name: node.name,
+            path: node.path,
+            type: 'folder',
+            children: node.childNodes()
+                .filter(child => child.count > 0)
+                .map(child => this.buildTree(child, basePath)),
+            files: node.fileNames().map(name => {
+                const fullPath = path.join(node.path, name);
+                return { name, path: fullPath, relativePath: path.relative(basePath, fullPath) };
+            })
+        };
+    }
+
+    // Header metadata for PCD files in the index (null when unreadable or
+    // without a probe backend). Only files not probed since they last
+    // changed are read.
+    async metaFor(filePaths) {
+        const missing = [];
+        const entries = filePaths.map(filePath => {
+            const node = this.node(path.dirname(filePath));
+            const name = path.basename(filePath);
+            if (node && node.files.has(name) && !node.meta.has(name) && this.backend.probe) {
+                missing.push(filePath);
+            }
+            return { node, name };
+        });
+
+        if (missing.length > 0) {
+            const probed = await this.backend.probe(missing);
+            missing.forEach((filePath, i) => {
+                const node = this.node(path.dirname(filePath));
+                const name = path.basename(filePath);
+                if (node && node.files.has(name)) node.meta.set(name, probed[i]);
+            });
+        }
+        return entries.map(({ node, name }) => (node && node.meta.get(name)) || null);
+    }
+
+    dispose() {
+        this.disposed = true;
+        clearTimeout(this.eventTimer);
+        if (this.treeWatcher) this.treeWatcher.close();
+        this.closeWatchers(this.rootNode);
+    }
+
+    // --- Scanning ---
+
+    async readDir(dirPath) {
+        while (this.activeReads >= READDIR_CONCURRENCY) {
+            await new Promise(resolve => this.readWaiters.push(resolve));
+        }
+        this.activeReads++;
+        try {
+            return await fs.promises.readdir(dirPath, { withFileTypes: true });
+        } catch (e) {
+            return []; // Ignore permission errors
+        } finally {
+            this.activeReads--;
+            const next = this.readWaiters.shift();
+            if (next) next();
+        }
+    }
+
+    async scan(node) {
+        this.watchDir(node);
+        const entries = await this.readDir(node.path);
+        if (this.disposed) return;
+
+        const subdirs = [];
+        let files = 0;
+        for (const entry of entries) {
+            if (entry.name.startsWith('.')) continue;
+            if (entry.isDirectory()) {
+                const child = new DirNode(path.join(node.path, entry.name), node);
+                node.children.set(entry.name, child);
+                subdirs.push(child);
+            } else if (isPcdName(entry.name) && !node.files.has(entry.name)) {
+                node.files.add(entry.name);
+                files++;
+            }
+        }
+        node.sortedFiles = null;
+        node.sortedChildren = null;
+        this.addCount(node, files);
+
+        await Promise.all(subdirs.map(child => this.scan(child)));
+    }
+
+    // Initial walk by the backend. Per-directory watchers are attached once
+    // it returns, so changes made during the walk itself may be missed.
+    async scanWithBackend() {
+        let result;
+        try {
+            result = await this.backend.scan(this.root);
+        } catch (e) {
+            result = { directories: [], files: [] };
+        }
+        if (this.disposed) return;
+
+        // Parents sort before their children
+        const nodes = new Map([['', this.rootNode]]);
+        for (const relative of result.directories) {
+            const parent = nodes.get(path.posix.dirname(relative).replace(/^\.$/, ''));
+            if (!parent) continue;
+            const child = new DirNode(path.join(this.root, relative), parent);
+            parent.children.set(child.name, child);
+            nodes.set(relative, child);
+        }
+        for (const relative of result.files) {
+            const parent = nodes.get(path.posix.dirname(relative).replace(/^\.$/, ''));
+            if (parent) parent.files.add(path.posix.basename(relative));
+        }
+        for (const node of nodes.values()) {
+            this.addCount(node, node.files.size);
+            this.watchDir(node);
+        }
+    }
+
+    addCount(node, delta) {
+        for (let n = node; n && delta !== 0; n = n.parent) n.count += delta;
+    }
+
+    removeChild(parent, name) {
+        const child = parent.children.get(name);
+        this.closeWatchers(child);
+        this.addCount(parent, -child.count);
+        parent.children.delete(name);
+        parent.sortedChildren = null;
+    }
+
+    // --- Watching ---
+
+    watchDir(node) {
+        if (NATIVE_RECURSIVE_WATCH || !this.live || this.disposed) return;
+        try {
+            node.watcher = fs.watch(node.path, (event, filename) => {
+                this.queueEvent(filename ? path.join(node.path, filename.toString()) : node.path);
+            });
+            node.watcher.on('error', err => this.watchFailed(err));
+        } catch (err) {
+            this.watchFailed(err);
+        }
+    }
+
+    closeWatchers(node) {
+        if (node.watcher) {
+            node.watcher.close();
+            node.watcher = null;
+        }
+        node.children.forEach(child => this.closeWatchers(child));
+    }
+
+    // Out of watch descriptors (ENOSPC / EMFILE) or the root went away: keep
+    // serving the scanned state and let the owner rebuild it periodically
+    watchFailed(err) {
+        if (!this.live) return;
+        this.live = false;
+        console.warn(`⚠️  Cannot watch ${this.root} (${err.code || err.message}), index refreshes every ${UNWATCHED_TTL_MS / 1000}s`);
+        if (this.treeWatcher) this.treeWatcher.close();
+        this.closeWatchers(this.rootNode);
+    }
+
+    queueEvent(fullPath) {
+        this.pendingEvents.add(fullPath);
+        if (!this.eventTimer) {
+            this.eventTimer = setTimeout(() => this.flushEvents(), EVENT_DELAY_MS);
+        }
+    }
+
+    async flushEvents() {
+        const paths = [...this.pendingEvents];
+        this.pendingEvents.clear();
+        this.eventTimer = null;
+        await this.ready;
+        for (const fullPath of paths) {
+            if (this.disposed) return;
+            await this.reconcile(fullPath);
+        }
+    }
+
+    // Bring the index entry for fullPath in line with the filesystem
+    async reconcile(fullPath) {
+        const dirNode = this.node(fullPath);
+        if (dirNode) {
+            // An indexed directory may itself have been removed or renamed
+            if (dirNode.parent) {
+                await this.reconcileEntry(dirNode.parent, dirNode.name);
+                if (dirNode.parent.children.get(dirNode.name) !== dirNode) return;
+            }
+            // Otherwise recheck every entry it has or had
+            const entries = await this.readDir(fullPath);
+            const names = new Set([...dirNode.files, ...dirNode.children.keys()]);
+            entries.forEach(entry => names.add(entry.name));
+            for (const name of names) {
+                await this.reconcileEntry(dirNode, name);
+            }
+            return;
+        }
+
+        const parent = this.node(path.dirname(fullPath));
+        if (parent) await this.reconcileEntry(parent, path.basename(fullPath));
+    }
+
+    async reconcileEntry(parent, name) {
+        if (name.startsWith('.')) return;
+
+        const fullPath = path.join(parent.path, name);
+        parent.meta.delete(name);
+        let stat = null;
+        try {
+            stat = await fs.promises.lstat(fullPath);
+        } catch (e) {
+            // Removed
+        }
+        if (this.disposed) return;
+
+        const isDir = stat !== null && stat.isDirectory();
+        const isPcd = stat !== null && !isDir && isPcdName(name);
+
+        if (!isDir && parent.children.has(name)) {
+            this.removeChild(parent, name);
+        }
+        if (!isPcd && parent.files.has(name)) {
+            parent.files.delete(name);
+            parent.sortedFiles = null;
+            this.addCount(parent, -1);
+        }
+        if (isDir && !parent.children.has(name)) {
+            const child = new DirNode(fullPath, parent);
+            parent.children.set(name, child);
+            parent.sortedChildren = null;
+            await this.scan(child);
+        }
+        if (isPcd && !parent.files.has(name)) {
+            parent.files.add(name);
+            parent.sortedFiles = null;
+            this.addCount(parent, 1);
+        }
+    }
+}
+
+// Indexes keyed by root. A directory inside an indexed root is answered by
+// that index; the least recently used roots are dropped beyond MAX_ROOTS.
+class PcdIndexManager {
+    constructor(backend = {}) {
+        this.backend = backend;
+        this.indexes = new Map(); // root -> PcdIndex, least recently used first
+    }
+
+    // Ready index that contains dirPath, building one rooted there if needed
+    async forDirectory(dirPath) {
+        for (const [root, index] of this.indexes) {
+            const relative = path.relative(root, dirPath);
+            if (relative.startsWith('..') || path.isAbsolute(relative)) continue;
+            await index.ready;
+            if (index.disposed || !index.node(dirPath)) continue;
+
+            this.indexes.delete(root);
+            this.indexes.set(root, index);
+            if (index.isStale()) this.rebuild(root);
+            return index;
+        }
+
+        const index = this.create(dirPath);
+        await index.ready;
+        // Indexes of subdirectories are now redundant
+        for (const [root, other] of this.indexes) {
+            if (other !== index && index.node(root)) {
+                other.dispose();
+                this.indexes.delete(root);
+            }
+        }
+        return index;
+    }
+
+    create(root) {
+        const index = new PcdIndex(root, this.backend);
+        this.indexes.set(root, index);
+        while (this.indexes.size > MAX_ROOTS) {
+            const [oldest, stale] = this.indexes.entries().next().value;
+            stale.dispose();
+            this.indexes.delete(oldest);
+        }
+        return index;
+    }
+
+    // Replace an unwatched index in the background; the old one keeps
+    // answering until the new scan completes
+    rebuild(root) {
+        const old = this.indexes.get(root);
+        if (old.rebuilding) return;
+        old.rebuilding = true;
+        const index = new PcdIndex(root, this.backend);
+        index.ready.then(() => {
+            if (this.indexes.get(root) === old) {
+                this.indexes.set(root, index);
+            } else {
+                index.dispose();
+            }
+            old.dispose();
+        });
+    }
+}
+
+module.exports = { PcdIndex, PcdIndexManager };
@@ -6,6 +6,9 @@ class App {
         this.viewer = null;
         this.labelManager = new LabelManager();
         this.selectionManager = null;
+        this.voxelSize = 0;   // Voxel preview leaf size for loads (0 = full)
+        this.loadedVoxel = 0; // Leaf size of the loaded cloud
+        this.smoothPath = null; // Server path of the cloud label smoothing runs on
         this.fileBrowser = new FileBrowser();
         this.folderModal = new FolderModal();
         this.activeLabel = 0;
@@ -23,6 +26,9 @@ class App {
         // Initialize selection manager
         this.selectionManager = new SelectionManager(this.viewer);
 
+        // Large clouds are drawn through a level-of-detail index
+        this.lodStreamer = new LodStreamer(this.viewer, (url, init) => this.fetchColumns(url, init));
+
         // Load label configuration
         await this.labelManager.loadConfig();
         this.viewer.setLabelColors(this.labelManager.labels);
@@ -132,9 +138,7 @@ class App {
 
         // Colorization
         document.getElementById('colorize-mode').addEventListener('change', (e) => {
-            this.viewer.setColorMode(e.target.value);
-            this.updateColorBoundsControls();
-            this.updateColors();
+            this.applyColorMode(e.target.value);
         });
 
         // Color bounds sliders
@@ -167,11 +171,24 @@ class App {
         // Store conversion function for use elsewhere
         this.sliderToPointSize = sliderToPointSize;
 
+        // Voxel preview: reload the current file downsampled (or in full)
+        const voxelSelect = document.getElementById('voxel-preview');
+        voxelSelect.addEventListener('change', async () => {
+            const file = this.fileBrowser.getCurrentFile();
+            if (file && !this.confirmDiscardChanges()) {
+                voxelSelect.value = String(this.voxelSize);
+                return;
+            }
+            this.voxelSize = parseFloat(voxelSelect.value) || 0;
+            if (file) await this.loadFileInternal(file);
+        });
+
         // Reset view
         document.getElementById('btn-reset-view').addEventListener('click', () => this.viewer.resetView());
 
         // Clear selection
         document.getElementById('btn-clear-selection').addEventListener('click', () => this.clearSelection());
+        document.getElementById('btn-smooth-labels').addEventListener('click', () => this.smoothLabels());
 
         // Label configuration
         document.getElementById('btn-edit-labels').addEventListener('click', () => this.showLabelConfigModal());
@@ -241,6 +258,12 @@ class App {
                 return;
             }
 
+            // Smooth labels
+            if (key === 'm') {
+                this.smoothLabels();
+                return;
+            }
+
             // Reset view
             if (key === 'r') {
                 this.viewer.resetView();
@@ -298,13 +321,13 @@ class App {
             }
         });
 
-        canvas.addEventListener('pointerup', (e) => {
+        canvas.addEventListener('pointerup', async (e) => {
             if (e.button !== 0) return;
             if (!isDragging) return;
 
             canvas.releasePointerCapture(e.pointerId);
             isDragging = false;
-            this.selectionManager.endSelection(e.clientX, e.clientY);
+            await this.selectionManager.endSelection(e.clientX, e.clientY);
 
             // Auto-apply active label if there's a selection and an active label
             const selectedIndices = this.selectionManager.getSelectedIndices();
@@ -434,6 +457,11 @@ class App {
         fileNode.className = 'tree-file';
         fileNode.dataset.index = globalIndex;
         fileNode.dataset.path = file.path;
+        if (file.meta) {
+            // Header metadata from /api/files (no point data decoded)
+            fileNode.title = `${file.meta.points.toLocaleString()} points · ` +
+                `${file.meta.dataType} · ${file.meta.fields.join(' ')}`;
+        }
         fileNode.innerHTML = `
             <span class="tree-file-icon">📄</span>
             <span class="tree-file-name">${file.name}</span>
@@ -519,22 +547,18 @@ class App {
     async loadFileInternal(file) {
         try {
             // Fetch PCD data from native parser API
-            const response = await fetch(`/api/pcd/parse?path=${encodeURIComponent(file.path)}`);
-            const data = await response.json();
-
-            if (data.error) {
-                throw new Error(data.error);
-            }
+            const data = await this.fetchPointCloud(file.path);
 
             // Load data into viewer
             const result = this.viewer.loadFromData(data);
+            this.setCloudSource(file.path, result.pointCount, data.header.voxel);
 
             // Initialize labels for this point cloud
             this.labelManager.initForPointCloud(result.pointCount);
 
             // Apply embedded labels from PCD if present
             if (result.labels) {
-                this.labelManager.setPointLabels(Array.from(result.labels));
+                this.labelManager.setPointLabels(result.labels);
             }
 
             // Update colorize dropdown with available fields
@@ -566,6 +590,97 @@ class App {
         }
     }
 
+    // Decode a binary column payload from /api/pcd/parse or /api/pcd/field:
+    // [u32 JSON length][JSON { header, columns }][pad to 8][column blobs].
+    // Columns become TypedArray views over the response buffer (no copies).
+    async fetchColumns(url, init) {
+        const response = await fetch(url, init);
+        if (!response.ok) {
+            const err = await response.json().catch(() => ({}));
+            throw new Error(err.error || `HTTP ${response.status}`);
+        }
+
+        const buffer = await response.arrayBuffer();
+        const jsonLength = new DataView(buffer).getUint32(0, true);
+        const meta = JSON.parse(new TextDecoder().decode(new Uint8Array(buffer, 4, jsonLength)));
+        const blobStart = Math.ceil((4 + jsonLength) / 8) * 8;
+
+        const arrayTypes = {
+            float32: Float32Array, float64: Float64Array,
+            uint32: Uint32Array, int32: Int32Array,
+            uint16: Uint16Array, int16: Int16Array,
+            uint8: Uint8Array, int8: Int8Array
+        };
+
+        const columns = meta.columns.map(col => {
+            const ArrayType = arrayTypes[col.type] || Float32Array;
+            return { ...col, data: new ArrayType(buffer, blobStart + col.offset, col.length) };
+        });
+        return { header: meta.header, columns };
+    }
+
+    // Fetch a point cloud (positions, labels and the eagerly decoded fields),
+    // as a voxel preview when one is selected
+    async fetchPointCloud(filePath) {
+        const params = new URLSearchParams({ path: filePath });
+        if (this.voxelSize > 0) params.set('voxel', this.voxelSize);
+        const { header, columns } = await this.fetchColumns(`/api/pcd/parse?${params}`);
+
+        const data = { header, positions: null, labels: null, fields: {} };
+        for (const col of columns) {
+            if (col.key === 'field') {
+                data.fields[col.name] = col.data;
+            } else {
+                data[col.key] = col.data;
+            }
+        }
+        return data;
+    }
+
+    // Point the server-backed helpers at the loaded cloud. Native selection,
+    // label smoothing and LOD drawing index full-resolution points, so they
+    // stay off for voxel previews.
+    setCloudSource(filePath, pointCount, voxel) {
+        this.loadedVoxel = voxel ? voxel.size : 0;
+        const fullPath = this.loadedVoxel ? null : filePath;
+        this.smoothPath = fullPath;
+        this.selectionManager.setSourcePath(fullPath);
+        this.lodStreamer.setSource(fullPath, pointCount);
+    }
+
+    // Load a colorization field on first use (parse only decodes positions,
+    // labels and color)
+    async ensureFieldLoaded(name) {
+        const colorizer = this.viewer.colorizer;
+        if (name === 'label' || name === '_color' || colorizer.getField(name)) return;
+
+        const file = this.fileBrowser.getCurrentFile();
+        if (!file || !file.path || file.path.startsWith('fs:')) return;
+
+        const params = new URLSearchParams({ path: file.path, name: name });
+        if (this.loadedVoxel > 0) params.set('voxel', this.loadedVoxel);
+        const url = `/api/pcd/field?${params}`;
+        const { columns } = await this.fetchColumns(url);
+
+        // Ignore the result if another file was loaded meanwhile
+        if (this.fileBrowser.getCurrentFile() !== file || !columns.length) return;
+        colorizer.addFieldData(name, columns[0].data);
+    }
+
+    // Switch the colorize mode, loading its field first if needed
+    async applyColorMode(mode) {
+        try {
+            await this.ensureFieldLoaded(mode);
+        } catch (err) {
+            console.error(`Failed to load field ${mode}:`, err);
+        }
+        if (document.getElementById('colorize-mode').value !== mode) return;
+
+        this.viewer.setColorMode(mode);
+        this.updateColorBoundsControls();
+        this.updateColors();
+    }
+
     async previousFile() {
         if (!this.fileBrowser.hasPrevious()) return;
 
@@ -621,15 +736,16 @@ class App {
             // Get selected format from dropdown
             const format = document.getElementById('save-format').value;
 
-            // Use native parser API to update labels in PCD file  
-            const response = await fetch('/api/pcd/update-labels', {
+            // Send only the points relabelled since the last save; the server
+            // applies them on top of the labels in the file.
+            // format: '' = auto (preserve original), or 'ascii'/'binary'/'binary_compressed'
+            // voxel: labels of a preview's points cover every point of their voxels
+            const params = new URLSearchParams({ path: filePath, format: format });
+            if (this.loadedVoxel > 0) params.set('voxel', this.loadedVoxel);
+            const response = await fetch(`/api/pcd/label-delta?${params}`, {
                 method: 'POST',
-                headers: { 'Content-Type': 'application/json' },
-                body: JSON.stringify({
-                    pcdPath: filePath,
-                    labels: Array.from(this.labelManager.pointLabels),
-                    format: format  // '' = auto (preserve original), or 'ascii'/'binary'/'binary_compressed'
-                })
+                headers: { 'Content-Type': 'application/octet-stream' },
+                body: this.labelManager.getLabelDelta()
             });
 
             const result = await response.json();
@@ -676,15 +792,11 @@ class App {
 
         // Reload the file
         try {
-            const response = await fetch(`/api/pcd/parse?path=${encodeURIComponent(currentFile.path)}`);
-            const data = await response.json();
-
-            if (data.error) {
-                throw new Error(data.error);
-            }
+            const data = await this.fetchPointCloud(currentFile.path);
 
             // Load data into viewer
             const result = this.viewer.loadFromData(data);
+            this.setCloudSource(currentFile.path, result.pointCount, data.header.voxel);
 
             // Initialize labels
             this.labelManager.initForPointCloud(result.pointCount);
@@ -792,6 +904,59 @@ class App {
         this.selectionManager.clearSelection();
     }
 
+    // Clean speckle noise: the selected points (every point when nothing is
+    // selected) take the majority label of their nearest neighbours. With a
+    // selection, unlabeled neighbours do not vote, so labels also spread into
+    // the unlabeled points selected.
+    async smoothLabels() {
+        const path = this.smoothPath;
+        const labels = this.labelManager.getPointLabels();
+        if (!path || !labels) {
+            alert('Label smoothing needs a full-resolution cloud opened through the folder browser');
+            return;
+        }
+
+        const selected = this.selectionManager.getSelectedIndices();
+        const n = labels.length;
+        const body = new Uint8Array(n + (selected.size > 0 ? Math.ceil(n / 8) : 0));
+        body.set(labels);
+        selected.forEach(idx => { body[n + (idx >> 3)] |= 1 << (idx & 7); });
+        const params = new URLSearchParams({ path, points: n, k: 8, fill: selected.size > 0 ? 1 : 0 });
+
+        try {
+            const response = await fetch(`/api/pcd/smooth-labels?${params}`, {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/octet-stream' },
+                body
+            });
+            if (!response.ok) {
+                const result = await response.json().catch(() => ({}));
+                throw new Error(result.error || response.statusText);
+            }
+            const smoothed = new Uint8Array(await response.arrayBuffer());
+            if (path !== this.smoothPath) return; // Another cloud was loaded meanwhile
+
+            // Apply through the label manager so the changes are saved as
+            // deltas, one assignment per new label
+            const byLabel = new Map();
+            const current = this.labelManager.getPointLabels();
+            for (let i = 0; i < n; i++) {
+                if (smoothed[i] === current[i]) continue;
+                if (!byLabel.has(smoothed[i])) byLabel.set(smoothed[i], new Set());
+                byLabel.get(smoothed[i]).add(i);
+            }
+            let changed = 0;
+            byLabel.forEach((indices, labelId) => {
+                this.labelManager.assignLabel(indices, labelId);
+                changed += indices.size;
+            });
+            this.selectionManager.clearSelection();
+            this.showNotification(`Smoothed labels: ${changed.toLocaleString()} points changed`, 'success');
+        } catch (err) {
+            alert('Failed to smooth labels: ' + err.message);
+        }
+    }
+
     onLabelsChanged() {
         this.updateColors();
         this.updateStatusBar();
@@ -892,9 +1057,14 @@ class App {
             select.value = currentValue;
         }
 
-        // Apply the color mode and update controls
+        // Apply the color mode and update controls (a restored field mode
+        // may still need to be loaded; colors refresh once it arrives)
         this.viewer.setColorMode(select.value);
         this.updateColorBoundsControls();
+        const mode = select.value;
+        if (mode !== 'label' && mode !== '_color' && !this.viewer.colorizer.getField(mode)) {
+            this.applyColorMode(mode);
+        }
     }
 
     cycleColorMode() {
@@ -904,9 +1074,7 @@ class App {
         const nextIndex = (currentIndex + 1) % options.length;
         select.selectedIndex = nextIndex;
 
-        this.viewer.setColorMode(select.value);
-        this.updateColorBoundsControls();
-        this.updateColors();
+        this.applyColorMode(select.value);
     }
 
     // Update color bounds controls visibility and values based on current mode
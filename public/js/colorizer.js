@@ -44,22 +44,31 @@ class Colorizer {
 
     // Set field data from native parser (includes synthetic _color if RGB available)
     setFieldData(fields) {
-        this.fieldData = fields || {};
+        this.fieldData = {};
+        this.fieldBounds = {};
 
         // Compute bounds for all numeric fields (except _color which is special)
-        this.fieldBounds = {};
-        for (const [name, data] of Object.entries(this.fieldData)) {
-            if (name === '_color') continue; // Skip synthetic color field
-            if (data && data.length > 0) {
-                let min = Infinity;
-                let max = -Infinity;
-                for (let i = 0; i < data.length; i++) {
-                    const v = data[i];
-                    if (v < min) min = v;
-                    if (v > max) max = v;
-                }
-                this.fieldBounds[name] = { min, max };
+        for (const [name, data] of Object.entries(fields || {})) {
+            if (name === '_color') {
+                this.fieldData[name] = data; // Synthetic color field has no bounds
+                continue;
+            }
+            this.addFieldData(name, data);
+        }
+    }
+
+    // Add a field loaded after the initial parse and compute its bounds
+    addFieldData(name, data) {
+        this.fieldData[name] = data;
+        if (data && data.length > 0) {
+            let min = Infinity;
+            let max = -Infinity;
+            for (let i = 0; i < data.length; i++) {
+                const v = data[i];
+                if (v < min) min = v;
+                if (v > max) max = v;
             }
+            this.fieldBounds[name] = { min, max };
         }
     }
 
@@ -12,7 +12,7 @@ class FileBrowser {
 
     async loadDirectory(dirPath) {
         try {
-            const response = await fetch(`/api/files?dir=${encodeURIComponent(dirPath)}`);
+            const response = await fetch(`/api/files?dir=${encodeURIComponent(dirPath)}&meta=true`);
             const result = await response.json();
 
             if (result.error) {
@@ -5,6 +5,7 @@ class LabelManager {
     constructor() {
         this.labels = [];
         this.pointLabels = null;
+        this.changed = null;  // Per point: label assigned since the last save
         this.pointCount = 0;
         this.dirty = false;
         this.onLabelsChanged = null;
@@ -50,12 +51,14 @@ class LabelManager {
     initForPointCloud(numPoints) {
         this.pointCount = numPoints;
         this.pointLabels = new Uint8Array(numPoints);
+        this.changed = new Uint8Array(numPoints);
         this.dirty = false;
     }
 
     setPointLabels(labels) {
         if (labels && labels.length === this.pointCount) {
             this.pointLabels = new Uint8Array(labels);
+            this.changed.fill(0);
         }
     }
 
@@ -82,6 +85,7 @@ class LabelManager {
         // Apply new labels
         selectedIndices.forEach(idx => {
             this.pointLabels[idx] = labelId;
+            this.changed[idx] = 1;
         });
 
         this.dirty = true;
@@ -96,6 +100,29 @@ class LabelManager {
 
     markClean() {
         this.dirty = false;
+        if (this.changed) this.changed.fill(0);
+    }
+
+    /**
+     * Labels assigned since the last save, for /api/pcd/label-delta
+     * @returns {Uint32Array} (start, count, label) triples of runs of changed
+     *     points sharing one label
+     */
+    getLabelDelta() {
+        const runs = [];
+        const n = this.pointCount;
+        let i = 0;
+        while (i < n) {
+            if (!this.changed[i]) {
+                i++;
+                continue;
+            }
+            const start = i;
+            const label = this.pointLabels[i];
+            while (i < n && this.changed[i] && this.pointLabels[i] === label) i++;
+            runs.push(start, i - start, label);
+        }
+        return new Uint32Array(runs);
     }
 }
 
@@ -0,0 +1,114 @@
+/**
+ * LodStreamer - Draws large point clouds through a level-of-detail index
+ * The full cloud stays loaded, so labels, selection and colors still cover
+ * every point; only the points of the LOD nodes the server picks for the
+ * current view (by frustum and screen-space spacing) are drawn.
+ */
+class LodStreamer {
+    constructor(viewer, fetchColumns) {
+        this.viewer = viewer;
+        this.fetchColumns = fetchColumns;
+        this.minPoints = 2000000; // Smaller clouds are drawn in full
+        this.pointBudget = 1500000;
+        this.errorPixels = 1.5;
+
+        this.path = null;
+        this.nodes = new Map(); // Node id -> Uint32Array of point indices
+        this.drawIndex = null;
+        this.timer = null;
+        this.inFlight = false;
+        this.dirty = false;
+
+        viewer.controls.addEventListener('change', () => this.scheduleUpdate());
+        window.addEventListener('resize', () => this.scheduleUpdate());
+    }
+
+    // Call after the viewer loads a cloud from the server
+    setSource(path, pointCount) {
+        this.nodes.clear();
+        this.path = path && pointCount >= this.minPoints ? path : null;
+        if (this.path) {
+            this.drawIndex = new Uint32Array(this.pointBudget);
+            this.scheduleUpdate();
+        } else {
+            this.drawIndex = null;
+        }
+    }
+
+    scheduleUpdate() {
+        if (!this.path) return;
+        clearTimeout(this.timer);
+        this.timer = setTimeout(() => this.update(), 100);
+    }
+
+    async update() {
+        if (this.inFlight) {
+            this.dirty = true;
+            return;
+        }
+        this.inFlight = true;
+        const path = this.path;
+
+        try {
+            const camera = this.viewer.camera;
+            const points = this.viewer.points;
+            camera.updateMatrixWorld();
+            points.updateMatrixWorld();
+            const matrix = new THREE.Matrix4()
+                .multiplyMatrices(camera.projectionMatrix, camera.matrixWorldInverse)
+                .multiply(points.matrixWorld);
+
+            const { header, columns } = await this.fetchColumns('/api/pcd/lod', {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({
+                    pcdPath: path,
+                    matrix: matrix.elements,
+                    viewportHeight: this.viewer.renderer.domElement.clientHeight,
+                    errorPixels: this.errorPixels,
+                    pointBudget: this.pointBudget,
+                    known: Array.from(this.nodes.keys()),
+                    positions: false
+                })
+            });
+            if (path !== this.path) return; // Another cloud was loaded meanwhile
+
+            for (const col of columns) {
+                if (col.key === 'indices') this.nodes.set(Number(col.name), col.data);
+            }
+
+            let count = 0;
+            for (const id of header.visible) {
+                const indices = this.nodes.get(id);
+                if (!indices) continue;
+                this.drawIndex.set(indices, count);
+                count += indices.length;
+            }
+            this.viewer.setDrawIndex(this.drawIndex, count);
+
+            // Keep cached nodes within a few budgets' worth of points
+            let cached = 0;
+            this.nodes.forEach(indices => { cached += indices.length; });
+            if (cached > 4 * this.pointBudget) {
+                const visible = new Set(header.visible);
+                for (const id of Array.from(this.nodes.keys())) {
+                    if (!visible.has(id)) this.nodes.delete(id);
+                }
+            }
+        } catch (err) {
+            console.warn('LOD update failed, drawing every point:', err);
+            if (path === this.path) {
+                this.path = null;
+                this.viewer.setDrawIndex(null);
+            }
+        } finally {
+            this.inFlight = false;
+            if (this.dirty) {
+                this.dirty = false;
+                this.scheduleUpdate();
+            }
+        }
+    }
+}
+
+window.LodStreamer = LodStreamer;
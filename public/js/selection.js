@@ -9,6 +9,9 @@ class SelectionManager {
         this.isSelecting = false;
         this.startPoint = null;
         this.lassoPoints = [];
+        // Server path of the loaded cloud, for native selection (null when
+        // the cloud is only available in the browser)
+        this.sourcePath = null;
 
         this.overlay = document.getElementById('selection-overlay');
         this.ctx = this.overlay.getContext('2d');
@@ -33,6 +36,10 @@ class SelectionManager {
         return this.mode;
     }
 
+    setSourcePath(path) {
+        this.sourcePath = path || null;
+    }
+
     startSelection(x, y) {
         this.isSelecting = true;
         this.startPoint = { x, y };
@@ -52,7 +59,7 @@ class SelectionManager {
         }
     }
 
-    endSelection(x, y) {
+    async endSelection(x, y) {
         if (!this.isSelecting) return;
         this.isSelecting = false;
 
@@ -65,17 +72,30 @@ class SelectionManager {
 
         this.clearOverlay();
 
-        // Find points inside the polygon
-        const newSelection = this.selectPointsInPolygon(polygon);
+        // Find points inside the polygon, natively on the server when the
+        // cloud came from there
+        const positions = this.viewer.getPositions();
+        const bits = await this.selectPointsNative(polygon);
+        if (this.viewer.getPositions() !== positions) return; // Cloud replaced meanwhile
 
         // Toggle selection: deselect if already selected, select if not
-        newSelection.forEach(idx => {
+        const toggle = idx => {
             if (this.selectedIndices.has(idx)) {
                 this.selectedIndices.delete(idx); // Deselect
             } else {
                 this.selectedIndices.add(idx); // Select
             }
-        });
+        };
+        if (bits) {
+            for (let byte = 0; byte < bits.length; byte++) {
+                let mask = bits[byte];
+                for (let bit = 0; mask !== 0; bit++, mask >>= 1) {
+                    if (mask & 1) toggle(byte * 8 + bit);
+                }
+            }
+        } else {
+            this.selectPointsInPolygon(polygon).forEach(toggle);
+        }
 
         if (this.onSelectionChanged) {
             this.onSelectionChanged(this.selectedIndices);
@@ -150,6 +170,46 @@ class SelectionManager {
         ];
     }
 
+    /**
+     * Select points inside the polygon with the server's native kernel.
+     * Returns a bitset (bit i & 7 of byte i >> 3 per point), or null when the
+     * JavaScript fallback has to be used.
+     */
+    async selectPointsNative(polygon) {
+        const points = this.viewer.points;
+        if (!this.sourcePath || !points || polygon.length < 3) {
+            return null;
+        }
+
+        const camera = this.viewer.camera;
+        camera.updateMatrixWorld();
+        points.updateMatrixWorld();
+        const matrix = new THREE.Matrix4()
+            .multiplyMatrices(camera.projectionMatrix, camera.matrixWorldInverse)
+            .multiply(points.matrixWorld);
+        const rect = this.viewer.renderer.domElement.getBoundingClientRect();
+
+        try {
+            const response = await fetch('/api/pcd/select', {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({
+                    pcdPath: this.sourcePath,
+                    matrix: matrix.elements,
+                    viewport: [rect.left, rect.top, rect.width, rect.height],
+                    polygon: polygon.flatMap(p => [p.x, p.y])
+                })
+            });
+            if (!response.ok) return null;
+            const bits = new Uint8Array(await response.arrayBuffer());
+            const pointCount = this.viewer.getPointCount();
+            return bits.length === Math.ceil(pointCount / 8) ? bits : null;
+        } catch (err) {
+            console.warn('Native selection failed, using fallback:', err);
+            return null;
+        }
+    }
+
     /**
      * Find all points whose screen projection falls inside the polygon
      */
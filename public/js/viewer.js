@@ -85,7 +85,9 @@ class PointCloudViewer {
         }
 
         // Store positions and field data
-        this.positions = new Float32Array(data.positions);
+        this.positions = data.positions instanceof Float32Array
+            ? data.positions
+            : new Float32Array(data.positions);
         this.fieldData = data.fields || {};
 
         // Create geometry
@@ -168,6 +170,30 @@ class PointCloudViewer {
         this.points.geometry.attributes.color.needsUpdate = true;
     }
 
+    /**
+     * Draw only the points listed in indices[0..count) (level-of-detail
+     * drawing); null draws every point
+     */
+    setDrawIndex(indices, count) {
+        if (!this.points) return;
+        const geometry = this.points.geometry;
+
+        if (!indices) {
+            geometry.setIndex(null);
+            geometry.setDrawRange(0, Infinity);
+            return;
+        }
+
+        // The index buffer is reused while its array stays the same
+        if (!geometry.index || geometry.index.array !== indices) {
+            geometry.setIndex(new THREE.BufferAttribute(indices, 1));
+        }
+        geometry.index.updateRange.offset = 0;
+        geometry.index.updateRange.count = count;
+        geometry.index.needsUpdate = true;
+        geometry.setDrawRange(0, count);
+    }
+
     setColorMode(mode) {
         this.colorizer.setMode(mode);
     }
@@ -3,6 +3,7 @@ const cors = require('cors');
 const fs = require('fs');
 const path = require('path');
 const yaml = require('js-yaml');
+const { PcdIndexManager } = require('./pcd-index');
 
 // Parse CLI arguments for initial directory
 const args = process.argv.slice(2);
@@ -23,10 +24,25 @@ let pcdParser = null;
 try {
     pcdParser = require('./build/Release/pcd_parser.node');
     console.log('✅ Native PCD parser loaded');
+    // Parsed clouds are cached across requests (PCD_CACHE_MB=0 disables)
+    if (process.env.PCD_CACHE_MB !== undefined && pcdParser.setCacheBudget) {
+        pcdParser.setCacheBudget(Number(process.env.PCD_CACHE_MB) || 0);
+    }
+    // Octrees built for spatial queries persist here across restarts
+    if (process.env.PCD_OCTREE_DIR && pcdParser.setOctreeCacheDir) {
+        pcdParser.setOctreeCacheDir(path.resolve(process.env.PCD_OCTREE_DIR));
+    }
 } catch (err) {
     console.warn('⚠️  Native PCD parser not available, cannot load point clouds', err.message);
 }
 
+// PCD files per directory root, scanned once and kept current by fs.watch.
+// The native scanner walks new roots and reads headers on a thread pool.
+const pcdIndex = new PcdIndexManager(pcdParser && pcdParser.scanDirectoryAsync ? {
+    scan: root => pcdParser.scanDirectoryAsync(root),
+    probe: paths => pcdParser.probeFilesAsync(paths)
+} : {});
+
 const app = express();
 const PORT = process.env.PORT || 3000;
 
@@ -42,7 +58,39 @@ app.get('/api/config/startup', (req, res) => {
 });
 
 // API: Parse PCD file using native parser
-app.get('/api/pcd/parse', (req, res) => {
+// Decoding runs on the libuv thread pool so other requests are not blocked.
+// Responds with the binary payload described at sendColumns
+// (?format=json returns plain number arrays instead).
+// Only EAGER_FIELDS are decoded unless ?fields=all is given; the client loads
+// other fields on demand from /api/pcd/field
+const EAGER_FIELDS = ['x', 'y', 'z', 'label', 'rgb', 'rgba', 'r', 'g', 'b'];
+
+// Frames on each side of the opened one that are parsed into the native
+// cache in the background, in the navigation order of the last /api/files
+// listing (PCD_PREFETCH=0 disables)
+const PREFETCH_NEIGHBOURS = process.env.PCD_PREFETCH !== undefined
+    ? Math.max(0, parseInt(process.env.PCD_PREFETCH, 10) || 0) : 2;
+let navigationOrder = [];
+
+// Nearest frames first, alternating next and previous
+function neighbourPaths(filePath) {
+    const index = navigationOrder.indexOf(filePath);
+    if (index < 0) return [];
+    const paths = [];
+    for (let d = 1; d <= PREFETCH_NEIGHBOURS; d++) {
+        if (index + d < navigationOrder.length) paths.push(navigationOrder[index + d]);
+        if (index - d >= 0) paths.push(navigationOrder[index - d]);
+    }
+    return paths;
+}
+
+// Voxel preview leaf size from a query value (0 = full resolution)
+function voxelSize(value) {
+    const size = parseFloat(value);
+    return Number.isFinite(size) && size > 0 ? size : 0;
+}
+
+app.get('/api/pcd/parse', async (req, res) => {
     const filePath = req.query.path;
 
     if (!filePath) {
@@ -59,36 +107,151 @@ app.get('/api/pcd/parse', (req, res) => {
         return res.status(500).json({ error: 'Native parser not available' });
     }
 
-    try {
-        const data = pcdParser.parse(resolvedPath);
+    // Queued prefetches would compete with the frame actually requested
+    const prefetching = PREFETCH_NEIGHBOURS > 0 && pcdParser.prefetch;
+    if (prefetching) pcdParser.cancelPrefetch();
 
-        // Get field names from the fields object
-        const fieldNames = data.fields ? Object.keys(data.fields) : [];
+    try {
+        const allFields = req.query.fields === 'all' || req.query.format === 'json';
+        const options = allFields ? {} : { fields: EAGER_FIELDS };
+        // ?voxel=<leaf size> returns a downsampled preview, one point per voxel
+        const voxel = voxelSize(req.query.voxel);
+        const data = await pcdParser.parseAsync(resolvedPath, voxel ? { ...options, voxel } : options);
+        if (prefetching) pcdParser.prefetch(neighbourPaths(resolvedPath), options);
+
+        // Every field in the file, whether decoded yet or not
+        const fieldNames = [...data.header.fields];
+        if (data.fields && data.fields._color) fieldNames.push('_color');
+        const header = { ...data.header, fieldNames: fieldNames };
+        if (data.voxel) {
+            header.voxel = { size: data.voxel.size, sourcePoints: data.voxel.sourcePoints };
+        }
 
-        // Convert fields to regular arrays for JSON serialization
-        const fields = {};
-        if (data.fields) {
-            for (const [name, typedArray] of Object.entries(data.fields)) {
+        // Legacy JSON transport (number arrays) for scripts and debugging
+        if (req.query.format === 'json') {
+            const fields = {};
+            for (const [name, typedArray] of Object.entries(data.fields || {})) {
                 fields[name] = Array.from(typedArray);
             }
+            return res.json({
+                header: header,
+                positions: Array.from(data.positions),
+                labels: Array.from(data.labels),
+                fields: fields
+            });
         }
 
-        res.json({
-            header: {
-                ...data.header,
-                fieldNames: fieldNames
-            },
-            positions: Array.from(data.positions),
-            labels: Array.from(data.labels),
-            fields: fields
-        });
+        sendColumns(res, header, [
+            ['positions', 'positions', data.positions],
+            ['labels', 'labels', data.labels],
+            ...Object.entries(data.fields || {}).map(([name, arr]) => ['field', name, arr]),
+            // Original index of each preview point
+            ...(data.voxel ? [['indices', 'voxel', data.voxel.indices]] : [])
+        ]);
+    } catch (err) {
+        res.status(500).json({ error: err.message });
+    }
+});
+
+// API: Decode a single field of a PCD file (same binary payload as parse)
+app.get('/api/pcd/field', async (req, res) => {
+    const filePath = req.query.path;
+    const name = req.query.name;
+
+    if (!filePath || !name) {
+        return res.status(400).json({ error: 'Path and field name required' });
+    }
+
+    const resolvedPath = path.resolve(filePath);
+
+    if (!fs.existsSync(resolvedPath)) {
+        return res.status(404).json({ error: 'File not found' });
+    }
+
+    if (!pcdParser) {
+        return res.status(500).json({ error: 'Native parser not available' });
+    }
+
+    try {
+        // ?voxel= matches the points of a voxel preview parse
+        const values = await pcdParser.getFieldAsync(resolvedPath, name, { voxel: voxelSize(req.query.voxel) });
+        sendColumns(res, { name: name }, [['field', name, values]]);
+    } catch (err) {
+        res.status(500).json({ error: err.message });
+    }
+});
+
+// Binary column response (parse, field and lod endpoints):
+//   [u32 LE JSON length][JSON { header, columns }][pad to 8][column blobs]
+// Each column entry is { key, name, type, offset, length }: key is
+// 'positions', 'labels', 'field' or 'indices', offset is the byte offset of
+// the blob from the start of the blob section (8-byte aligned), length is the
+// element count. Blobs are the TypedArray bytes as-is (little-endian on every
+// platform the viewer runs on), so the client can view them without copying.
+const PAYLOAD_ALIGN = 8;
+const TYPED_ARRAY_TYPES = new Map([
+    [Float32Array, 'float32'], [Float64Array, 'float64'],
+    [Uint32Array, 'uint32'], [Int32Array, 'int32'],
+    [Uint16Array, 'uint16'], [Int16Array, 'int16'],
+    [Uint8Array, 'uint8'], [Int8Array, 'int8']
+]);
+
+function alignTo(n, alignment) {
+    return Math.ceil(n / alignment) * alignment;
+}
+
+// arrays: [key, name, TypedArray] triples in payload order
+function sendColumns(res, header, arrays) {
+    const columns = [];
+    let offset = 0;
+    for (const [key, name, arr] of arrays) {
+        columns.push({ key, name, type: TYPED_ARRAY_TYPES.get(arr.constructor), offset, length: arr.length });
+        offset = alignTo(offset + arr.byteLength, PAYLOAD_ALIGN);
+    }
+
+    const json = Buffer.from(JSON.stringify({ header, columns }));
+    const prefix = Buffer.alloc(alignTo(4 + json.length, PAYLOAD_ALIGN));
+    prefix.writeUInt32LE(json.length, 0);
+    json.copy(prefix, 4);
+
+    res.setHeader('Content-Type', 'application/octet-stream');
+    res.setHeader('Content-Length', prefix.length + offset);
+    res.write(prefix);
+    for (const [, , arr] of arrays) {
+        res.write(Buffer.from(arr.buffer, arr.byteOffset, arr.byteLength));
+        const pad = alignTo(arr.byteLength, PAYLOAD_ALIGN) - arr.byteLength;
+        if (pad > 0) res.write(Buffer.alloc(pad));
+    }
+    res.end();
+}
+
+// API: Read PCD header metadata (no point data)
+app.get('/api/pcd/probe', (req, res) => {
+    const filePath = req.query.path;
+
+    if (!filePath) {
+        return res.status(400).json({ error: 'Path required' });
+    }
+
+    const resolvedPath = path.resolve(filePath);
+
+    if (!fs.existsSync(resolvedPath)) {
+        return res.status(404).json({ error: 'File not found' });
+    }
+
+    if (!pcdParser) {
+        return res.status(500).json({ error: 'Native parser not available' });
+    }
+
+    try {
+        res.json(pcdParser.probe(resolvedPath));
     } catch (err) {
         res.status(500).json({ error: err.message });
     }
 });
 
 // API: Update labels in PCD file using native parser
-app.post('/api/pcd/update-labels', (req, res) => {
+app.post('/api/pcd/update-labels', async (req, res) => {
     const { pcdPath, labels, format } = req.body;
 
     if (!pcdPath || !labels) {
@@ -107,20 +270,181 @@ app.post('/api/pcd/update-labels', (req, res) => {
 
     try {
         const labelsArray = new Uint32Array(labels);
-        // Use format-aware save if format specified, otherwise auto-detect
-        if (format && format !== '') {
-            pcdParser.updateLabelsWithFormat(resolvedPath, labelsArray, format);
-        } else {
-            pcdParser.updateLabels(resolvedPath, labelsArray);
-        }
+        // Empty format preserves the original file format
+        await pcdParser.updateLabelsAsync(resolvedPath, labelsArray, format || '');
         res.json({ success: true, format: format || 'auto' });
     } catch (err) {
         res.status(500).json({ error: err.message });
     }
 });
 
+// API: Apply a label delta to a PCD file
+// Body: little-endian uint32 (start, count, label) triples for the changed
+// points only, applied on top of the labels in the file. ?format= converts
+// the file as well ('' keeps its format). ?voxel= marks runs over the points
+// of a voxel preview, which are expanded to every point of their voxels.
+app.post('/api/pcd/label-delta', express.raw({ type: 'application/octet-stream', limit: '100mb' }), async (req, res) => {
+    const filePath = req.query.path;
+    const format = req.query.format || '';
+    const voxel = voxelSize(req.query.voxel);
+
+    if (!filePath) {
+        return res.status(400).json({ error: 'Path required' });
+    }
+
+    if (!['', 'ascii', 'binary', 'binary_compressed'].includes(format)) {
+        return res.status(400).json({ error: 'Unknown format: ' + format });
+    }
+
+    const body = Buffer.isBuffer(req.body) ? req.body : Buffer.alloc(0);
+    if (body.length % 12 !== 0) {
+        return res.status(400).json({ error: 'Body must be uint32 (start, count, label) triples' });
+    }
+
+    const resolvedPath = path.resolve(filePath);
+
+    if (!fs.existsSync(resolvedPath)) {
+        return res.status(404).json({ error: 'File not found' });
+    }
+
+    if (!pcdParser) {
+        return res.status(500).json({ error: 'Native parser not available' });
+    }
+
+    try {
+        // Copy into an aligned buffer for the Uint32Array view
+        const runs = new Uint32Array(body.buffer.slice(body.byteOffset, body.byteOffset + body.length));
+        await pcdParser.applyLabelDeltaAsync(resolvedPath, runs, format, { voxel });
+        res.json({ success: true, runs: runs.length / 3, format: format || 'auto' });
+    } catch (err) {
+        res.status(500).json({ error: err.message });
+    }
+});
+
+// API: Select the points whose screen projection falls inside a polygon
+// Body: { pcdPath, matrix, viewport, polygon } with the 16-element world-to-
+// clip matrix, the [left, top, width, height] viewport and the flattened
+// [x0, y0, x1, y1, ...] polygon in the same pixel space. Responds with a
+// bitset (bit i & 7 of byte i >> 3 set for selected point i).
+app.post('/api/pcd/select', async (req, res) => {
+    const { pcdPath, matrix, viewport, polygon } = req.body;
+
+    if (!pcdPath || !Array.isArray(matrix) || !Array.isArray(viewport) || !Array.isArray(polygon)) {
+        return res.status(400).json({ error: 'pcdPath, matrix, viewport and polygon required' });
+    }
+
+    const resolvedPath = path.resolve(pcdPath);
+
+    if (!fs.existsSync(resolvedPath)) {
+        return res.status(404).json({ error: 'File not found' });
+    }
+
+    if (!pcdParser) {
+        return res.status(500).json({ error: 'Native parser not available' });
+    }
+
+    try {
+        const bits = await pcdParser.selectPolygonAsync(resolvedPath, matrix, viewport, polygon);
+        res.setHeader('Content-Type', 'application/octet-stream');
+        res.send(Buffer.from(bits.buffer, bits.byteOffset, bits.byteLength));
+    } catch (err) {
+        res.status(500).json({ error: err.message });
+    }
+});
+
+// API: Level-of-detail nodes to draw for a camera
+// Body: { pcdPath, matrix, viewportHeight, errorPixels?, pointBudget?,
+// known?, positions? } with the 16-element world-to-clip matrix. Responds
+// with the binary column payload: header { visible, nodes } lists the node
+// ids to draw (parents first) and the metadata of the nodes sent, i.e. the
+// visible ones not in `known`. Each sent node has an 'indices' column of
+// original point indices and, unless positions is false, a 'positions'
+// column, both named by node id.
+app.post('/api/pcd/lod', async (req, res) => {
+    const { pcdPath, matrix, viewportHeight, errorPixels, pointBudget, known, positions } = req.body;
+
+    if (!pcdPath || !Array.isArray(matrix) || typeof viewportHeight !== 'number') {
+        return res.status(400).json({ error: 'pcdPath, matrix and viewportHeight required' });
+    }
+
+    const resolvedPath = path.resolve(pcdPath);
+
+    if (!fs.existsSync(resolvedPath)) {
+        return res.status(404).json({ error: 'File not found' });
+    }
+
+    if (!pcdParser) {
+        return res.status(500).json({ error: 'Native parser not available' });
+    }
+
+    try {
+        const options = { known: Array.isArray(known) ? known : [], positions: positions !== false };
+        if (typeof errorPixels === 'number') options.errorPixels = errorPixels;
+        if (typeof pointBudget === 'number') options.pointBudget = pointBudget;
+
+        const result = await pcdParser.selectLodAsync(resolvedPath, matrix, viewportHeight, options);
+        const nodes = [];
+        const arrays = [];
+        for (const node of result.nodes) {
+            nodes.push({ id: node.id, level: node.level, spacing: node.spacing, min: node.min, max: node.max });
+            arrays.push(['indices', String(node.id), node.indices]);
+            if (node.positions) arrays.push(['positions', String(node.id), node.positions]);
+        }
+        sendColumns(res, { visible: Array.from(result.visible), nodes }, arrays);
+    } catch (err) {
+        res.status(500).json({ error: err.message });
+    }
+});
+
+// API: Smooth labels by majority vote over each point's nearest neighbours
+// Query: path, points (the cloud's point count), k?, radius?, iterations?,
+// fill? (1 = unlabeled neighbours do not vote, so labels spread into
+// unlabeled points). Body: points uint8 labels, optionally followed by a
+// selection bitset of the points to update (bit i & 7 of byte i >> 3;
+// omitted = all). Responds with the updated uint8 labels.
+app.post('/api/pcd/smooth-labels', express.raw({ type: 'application/octet-stream', limit: '100mb' }), async (req, res) => {
+    const filePath = req.query.path;
+    const points = parseInt(req.query.points, 10);
+
+    if (!filePath || !(points >= 0)) {
+        return res.status(400).json({ error: 'path and points required' });
+    }
+
+    const body = Buffer.isBuffer(req.body) ? req.body : Buffer.alloc(0);
+    const maskBytes = Math.ceil(points / 8);
+    if (body.length !== points && body.length !== points + maskBytes) {
+        return res.status(400).json({ error: 'Body must be the labels, optionally followed by a selection bitset' });
+    }
+
+    const resolvedPath = path.resolve(filePath);
+
+    if (!fs.existsSync(resolvedPath)) {
+        return res.status(404).json({ error: 'File not found' });
+    }
+
+    if (!pcdParser) {
+        return res.status(500).json({ error: 'Native parser not available' });
+    }
+
+    try {
+        const labels = Uint32Array.from(body.subarray(0, points));
+        const mask = body.length > points ? new Uint8Array(body.subarray(points)) : null;
+        const options = { ignoreUnlabeled: req.query.fill === '1' };
+        for (const key of ['k', 'radius', 'iterations']) {
+            const value = parseFloat(req.query[key]);
+            if (Number.isFinite(value)) options[key] = value;
+        }
+
+        const smoothed = await pcdParser.smoothLabelsAsync(resolvedPath, labels, mask, options);
+        res.setHeader('Content-Type', 'application/octet-stream');
+        res.send(Buffer.from(Uint8Array.from(smoothed)));
+    } catch (err) {
+        res.status(500).json({ error: err.message });
+    }
+});
+
 // API: Convert PCD file format (ASCII <-> Binary)
-app.post('/api/pcd/convert-format', (req, res) => {
+app.post('/api/pcd/convert-format', async (req, res) => {
     const { pcdPath, targetFormat } = req.body;
 
     if (!pcdPath || !targetFormat) {
@@ -142,37 +466,17 @@ app.post('/api/pcd/convert-format', (req, res) => {
     }
 
     try {
-        const toBinary = targetFormat === 'binary';
-        pcdParser.convertFormat(resolvedPath, toBinary);
+        await pcdParser.convertFormatAsync(resolvedPath, targetFormat);
         res.json({ success: true, format: targetFormat });
     } catch (err) {
         res.status(500).json({ error: err.message });
     }
 });
 
-// Helper function to count PCD files recursively in a directory
-function countPcdFilesRecursive(dirPath) {
-    let count = 0;
-    try {
-        const entries = fs.readdirSync(dirPath, { withFileTypes: true });
-        for (const entry of entries) {
-            if (entry.name.startsWith('.')) continue;
-            const fullPath = path.join(dirPath, entry.name);
-            if (entry.isDirectory()) {
-                count += countPcdFilesRecursive(fullPath);
-            } else if (entry.name.toLowerCase().endsWith('.pcd')) {
-                count++;
-            }
-        }
-    } catch (e) {
-        // Ignore permission errors
-    }
-    return count;
-}
-
 // API: Browse directories (for folder picker)
-app.get('/api/browse', (req, res) => {
+app.get('/api/browse', async (req, res) => {
     let dirPath = req.query.dir || process.env.HOME || '/';
+    const withMeta = req.query.meta === 'true';
 
     // Expand ~ to home directory
     if (dirPath.startsWith('~')) {
@@ -191,90 +495,26 @@ app.get('/api/browse', (req, res) => {
             return res.status(400).json({ error: 'Not a directory' });
         }
 
-        const entries = fs.readdirSync(resolvedPath, { withFileTypes: true });
-        const directories = [];
-        let pcdCount = 0;
-
-        entries.forEach(entry => {
-            if (entry.name.startsWith('.')) return; // Skip hidden files
-
-            if (entry.isDirectory()) {
-                // Count PCD files recursively in this subdirectory
-                let subPcdCount = 0;
-                try {
-                    const subPath = path.join(resolvedPath, entry.name);
-                    subPcdCount = countPcdFilesRecursive(subPath);
-                } catch (e) {
-                    // Ignore permission errors
-                }
-
-                directories.push({
-                    name: entry.name,
-                    path: path.join(resolvedPath, entry.name),
-                    pcdCount: subPcdCount
-                });
-            } else if (entry.name.toLowerCase().endsWith('.pcd')) {
-                pcdCount++;
-            }
-        });
-
-        directories.sort((a, b) => a.name.localeCompare(b.name));
-
-        res.json({
+        const index = await pcdIndex.forDirectory(resolvedPath);
+        const listing = index.list(resolvedPath);
+        const response = {
             current: resolvedPath,
             parent: path.dirname(resolvedPath),
-            directories,
-            pcdCount
-        });
+            directories: listing.directories,
+            pcdCount: listing.pcdCount
+        };
+        if (withMeta) {
+            const files = listing.files.map(name => ({ name, path: path.join(resolvedPath, name) }));
+            const meta = await index.metaFor(files.map(file => file.path));
+            files.forEach((file, i) => { file.meta = meta[i]; });
+            response.files = files;
+        }
+        res.json(response);
     } catch (err) {
         res.status(500).json({ error: err.message });
     }
 });
 
-// Helper function to recursively scan directories for PCD files
-function scanDirectoryRecursive(dirPath, basePath) {
-    const result = {
-        name: path.basename(dirPath),
-        path: dirPath,
-        type: 'folder',
-        children: [],
-        files: []
-    };
-
-    try {
-        const entries = fs.readdirSync(dirPath, { withFileTypes: true });
-
-        entries.forEach(entry => {
-            if (entry.name.startsWith('.')) return; // Skip hidden files
-
-            const fullPath = path.join(dirPath, entry.name);
-
-            if (entry.isDirectory()) {
-                // Recursively scan subdirectory
-                const subResult = scanDirectoryRecursive(fullPath, basePath);
-                // Only include folders that have PCD files somewhere
-                if (subResult.files.length > 0 || subResult.children.length > 0) {
-                    result.children.push(subResult);
-                }
-            } else if (entry.name.toLowerCase().endsWith('.pcd')) {
-                result.files.push({
-                    name: entry.name,
-                    path: fullPath,
-                    relativePath: path.relative(basePath, fullPath)
-                });
-            }
-        });
-
-        // Sort children and files alphabetically
-        result.children.sort((a, b) => a.name.localeCompare(b.name));
-        result.files.sort((a, b) => a.name.localeCompare(b.name));
-    } catch (err) {
-        console.error(`Error scanning ${dirPath}:`, err.message);
-    }
-
-    return result;
-}
-
 // Helper to flatten tree into a file list (for backwards compatibility)
 function flattenTree(node, allFiles = []) {
     allFiles.push(...node.files);
@@ -283,9 +523,10 @@ function flattenTree(node, allFiles = []) {
 }
 
 // API: List PCD files in a directory (recursively)
-app.get('/api/files', (req, res) => {
+app.get('/api/files', async (req, res) => {
     const dirPath = req.query.dir;
     const recursive = req.query.recursive !== 'false'; // Default to recursive
+    const withMeta = req.query.meta === 'true'; // Attach header metadata per file
 
     if (!dirPath) {
         return res.status(400).json({ error: 'Directory path required' });
@@ -298,11 +539,18 @@ app.get('/api/files', (req, res) => {
     }
 
     try {
+        const index = await pcdIndex.forDirectory(resolvedPath);
         if (recursive) {
-            // Scan recursively and return tree structure
-            const tree = scanDirectoryRecursive(resolvedPath, resolvedPath);
+            // Tree of folders containing PCD files
+            const tree = index.tree(resolvedPath);
             // Also provide a flat list of all files for navigation
             const allFiles = flattenTree(tree);
+            navigationOrder = allFiles.map(file => file.path);
+            if (withMeta) {
+                // Tree and flat list share file objects, so both get metadata
+                const meta = await index.metaFor(allFiles.map(file => file.path));
+                allFiles.forEach((file, i) => { file.meta = meta[i]; });
+            }
 
             res.json({
                 directory: resolvedPath,
@@ -311,13 +559,15 @@ app.get('/api/files', (req, res) => {
             });
         } else {
             // Non-recursive mode (original behavior)
-            const files = fs.readdirSync(resolvedPath)
-                .filter(file => file.toLowerCase().endsWith('.pcd'))
-                .map(file => ({
-                    name: file,
-                    path: path.join(resolvedPath, file)
-                }))
-                .sort((a, b) => a.name.localeCompare(b.name));
+            const files = index.list(resolvedPath).files.map(file => ({
+                name: file,
+                path: path.join(resolvedPath, file)
+            }));
+            navigationOrder = files.map(file => file.path);
+            if (withMeta) {
+                const meta = await index.metaFor(files.map(file => file.path));
+                files.forEach((file, i) => { file.meta = meta[i]; });
+            }
 
             res.json({ directory: resolvedPath, files });
         }